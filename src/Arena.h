@@ -0,0 +1,176 @@
+/*
+ * Arena.h
+ */
+#ifndef SRC_ARENA_H_
+#define SRC_ARENA_H_
+
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#define ARENA_BLOCO 65536 //bytes de cada bloco pedido ao sistema
+#define ARENA_ALINHAMENTO 16 //alinhamento de todos os pedidos (long double)
+#define ARENA_CLASSES 32 //tamanhos reciclados: multiplos de ARENA_ALINHAMENTO ate 512 bytes
+
+/** @file */
+
+/**
+ * Monotonic arena: hands out memory from large blocks by moving a pointer, and gives the blocks back
+ * to the system all at once, when it is destroyed.
+ * Memory given back with deallocate() is kept in a free list for its size (up to ARENA_CLASSES *
+ * ARENA_ALINHAMENTO bytes) and handed out again to the next request of the same size, so vertices
+ * removed from a graph and the old buffers of growing edge vectors are reused; larger pieces stay
+ * unused until the arena goes away. Not thread-safe.
+ */
+class Arena {
+	vector<char *> blocos;
+	char *atual;
+	size_t livre; //bytes que restam no bloco atual
+	size_t reservados; //bytes pedidos ao sistema
+	void *livres[ARENA_CLASSES]; //listas de pedacos devolvidos, ligadas pelo primeiro ponteiro
+
+	Arena(const Arena &);
+	Arena &operator=(const Arena &);
+
+	static size_t round(size_t bytes) {
+		return (bytes + ARENA_ALINHAMENTO - 1) / ARENA_ALINHAMENTO * ARENA_ALINHAMENTO;
+	}
+	char *newBlock(size_t bytes);
+public:
+	Arena();
+	~Arena() {
+		release();
+	}
+
+	void *allocate(size_t bytes);
+	void deallocate(void *p, size_t bytes);
+	void release();
+
+	/**
+	 * @return the bytes taken from the system, in getNumBlocks() blocks
+	 */
+	size_t getReservedBytes() const {
+		return reservados;
+	}
+	unsigned int getNumBlocks() const {
+		return blocos.size();
+	}
+};
+
+inline Arena::Arena() :
+		atual(NULL), livre(0), reservados(0) {
+	for (unsigned int i = 0; i < ARENA_CLASSES; i++)
+		livres[i] = NULL;
+}
+
+inline char *Arena::newBlock(size_t bytes) {
+	char *bloco = static_cast<char *>(malloc(bytes));
+	if (bloco == NULL)
+		throw bad_alloc();
+	blocos.push_back(bloco);
+	reservados += bytes;
+	return bloco;
+}
+
+/**
+ * @brief Memory for bytes bytes, aligned to ARENA_ALINHAMENTO.
+ * Requests larger than a quarter of ARENA_BLOCO get a block of their own, so they never waste the rest
+ * of the current block.
+ */
+inline void *Arena::allocate(size_t bytes) {
+	bytes = round(bytes == 0 ? 1 : bytes);
+	size_t classe = bytes / ARENA_ALINHAMENTO - 1;
+	if (classe < ARENA_CLASSES && livres[classe] != NULL) {
+		void *p = livres[classe];
+		livres[classe] = *static_cast<void **>(p);
+		return p;
+	}
+	if (bytes > ARENA_BLOCO / 4)
+		return newBlock(bytes);
+	if (bytes > livre) {
+		atual = newBlock(ARENA_BLOCO);
+		livre = ARENA_BLOCO;
+	}
+	void *p = atual;
+	atual += bytes;
+	livre -= bytes;
+	return p;
+}
+
+/**
+ * @brief Gives back memory from allocate(bytes), to be reused by requests of the same size.
+ */
+inline void Arena::deallocate(void *p, size_t bytes) {
+	size_t classe = round(bytes == 0 ? 1 : bytes) / ARENA_ALINHAMENTO - 1;
+	if (p == NULL || classe >= ARENA_CLASSES)
+		return;
+	*static_cast<void **>(p) = livres[classe];
+	livres[classe] = p;
+}
+
+/**
+ * @brief Frees every block at once. Everything allocated so far becomes invalid (no destructors are
+ * called).
+ */
+inline void Arena::release() {
+	for (unsigned int i = 0; i < blocos.size(); i++)
+		free(blocos[i]);
+	blocos.clear();
+	atual = NULL;
+	livre = 0;
+	reservados = 0;
+	for (unsigned int i = 0; i < ARENA_CLASSES; i++)
+		livres[i] = NULL;
+}
+
+/**
+ * Standard allocator over an Arena, for the containers owned by a graph. Without an arena it uses the
+ * global operator new, so the containers still work outside of a graph.
+ */
+template<class T>
+class ArenaAllocator {
+	Arena *arena;
+	template<class U> friend class ArenaAllocator;
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template<class U> struct rebind {
+		typedef ArenaAllocator<U> other;
+	};
+
+	ArenaAllocator(Arena *arena = NULL) :
+			arena(arena) {
+	}
+	template<class U> ArenaAllocator(const ArenaAllocator<U> &outro) :
+			arena(outro.arena) {
+	}
+
+	T *allocate(size_t n) {
+		if (arena == NULL)
+			return static_cast<T *>(::operator new(n * sizeof(T)));
+		return static_cast<T *>(arena->allocate(n * sizeof(T)));
+	}
+	void deallocate(T *p, size_t n) {
+		if (arena == NULL)
+			::operator delete(p);
+		else
+			arena->deallocate(p, n * sizeof(T));
+	}
+
+	template<class U> bool operator==(const ArenaAllocator<U> &outro) const {
+		return arena == outro.arena;
+	}
+	template<class U> bool operator!=(const ArenaAllocator<U> &outro) const {
+		return arena != outro.arena;
+	}
+};
+
+#endif /* SRC_ARENA_H_ */
@@ -0,0 +1,63 @@
+/*
+ * ArrayView.h
+ */
+#ifndef SRC_ARRAYVIEW_H_
+#define SRC_ARRAYVIEW_H_
+
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Read-only view over a contiguous array owned by someone else (a vector of the graph), without copying
+ * it. Works with range-based for loops, size() and operator[], like the vector it replaces in the
+ * interface. Only valid while the viewed array is not changed (adding or removing vertices or edges
+ * invalidates the views over them).
+ */
+template<class T>
+class ArrayView {
+	const T *inicio;
+	size_t tamanho;
+public:
+	typedef T value_type;
+	typedef const T *const_iterator;
+	typedef const T *iterator;
+
+	ArrayView() :
+			inicio(NULL), tamanho(0) {
+	}
+	ArrayView(const T *inicio, size_t tamanho) :
+			inicio(inicio), tamanho(tamanho) {
+	}
+	template<class A>
+	ArrayView(const vector<T, A> &v) :
+			inicio(v.empty() ? NULL : &v[0]), tamanho(v.size()) {
+	}
+
+	const T *begin() const {
+		return inicio;
+	}
+	const T *end() const {
+		return inicio + tamanho;
+	}
+	size_t size() const {
+		return tamanho;
+	}
+	bool empty() const {
+		return tamanho == 0;
+	}
+	const T &operator[](size_t i) const {
+		return inicio[i];
+	}
+	const T &front() const {
+		return inicio[0];
+	}
+	const T &back() const {
+		return inicio[tamanho - 1];
+	}
+};
+
+#endif /* SRC_ARRAYVIEW_H_ */
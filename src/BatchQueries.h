@@ -0,0 +1,195 @@
+/*
+ * BatchQueries.h
+ */
+#ifndef SRC_BATCHQUERIES_H_
+#define SRC_BATCHQUERIES_H_
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <exception>
+#include "NoInfo.h"
+#include "NodeIdMap.h"
+#include "FrozenGraph.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+#include "utils.h"
+
+#define PEDIDOS_POR_TAREFA 16
+
+/** @file */
+
+/**
+ * An origin/destination pair to be answered by the batch engine: the node ids of the map files, and the
+ * nodes of the graph they are (see resolveRouteQueries).
+ */
+struct RouteQuery {
+	BigAssInteger idOrigem;
+	BigAssInteger idDestino;
+	NoInfo origem;
+	NoInfo destino;
+};
+
+/**
+ * The answer to a RouteQuery: the cost of the route (infinity if there is none) and the route itself.
+ */
+struct RouteResult {
+	float custo;
+	vector<NoInfo> caminho;
+};
+
+/**
+ * @brief Reads the origin/destination pairs from a text file, one "origin;destination" pair of node ids (of the map files) per line.
+ * @param ficheiro the file with the pairs
+ * @return the pairs read
+ */
+vector<RouteQuery> readRouteQueries(const string& ficheiro) {
+	vector<RouteQuery> res;
+	ifstream inFile(ficheiro.c_str());
+	if (!inFile.is_open())
+		throw(exception());
+
+	string line;
+	while (getline(inFile, line)) {
+		stringstream linestream(line);
+		string data;
+		BigAssInteger idOrigem = 0, idDestino = 0;
+
+		if (!(linestream >> idOrigem))
+			continue;
+		getline(linestream, data, ';'); // read up-to the first ; (discard ;).
+		if (!(linestream >> idDestino))
+			continue;
+
+		RouteQuery pedido;
+		pedido.idOrigem = idOrigem;
+		pedido.idDestino = idDestino;
+		res.push_back(pedido);
+	}
+	return res;
+}
+
+/**
+ * @brief Finds the nodes of the graph of each query from their ids in the map files. Ids that aren't in
+ * the map get a node that isn't in the graph either, so those queries have no route.
+ * @param ids the node ids of the map, from abrirMapa
+ */
+void resolveRouteQueries(vector<RouteQuery>& pedidos, const NodeIdMap& ids) {
+	for (unsigned int i = 0; i < pedidos.size(); i++) {
+		pedidos[i].origem = NoInfo(ids.find(pedidos[i].idOrigem), 0, 0, ' ');
+		pedidos[i].destino = NoInfo(ids.find(pedidos[i].idDestino), 0, 0, ' ');
+	}
+}
+
+/**
+ * @brief Answers all the queries over a shared, read-only routing snapshot.
+ * The queries are split in blocks of PEDIDOS_POR_TAREFA that are scheduled on the pool, and each
+ * worker thread uses its own SearchWorkspace.
+ * @param rotas the routing snapshot
+ * @param pedidos the queries
+ * @param algoritmo "A*" or "Dijkstra"
+ * @param pool the threads that will run the queries
+ * @return one result per query, in the same order
+ */
+vector<RouteResult> runRouteQueries(const FrozenGraph<NoInfo>& rotas,
+		const vector<RouteQuery>& pedidos, const string& algoritmo,
+		ThreadPool& pool) {
+	vector<RouteResult> res(pedidos.size());
+	vector<SearchWorkspace<float> > workspaces(pool.size());
+	bool aStar = (algoritmo == "A*");
+	GeoPoints pontos;
+	if (aStar)
+		pontos = GeoPoints(rotas);
+
+	for (unsigned int inicio = 0; inicio < pedidos.size(); inicio +=
+	PEDIDOS_POR_TAREFA) {
+		unsigned int fim = inicio + PEDIDOS_POR_TAREFA;
+		if (fim > pedidos.size())
+			fim = pedidos.size();
+
+		pool.submit([&, inicio, fim](unsigned int worker) {
+			SearchWorkspace<float> &ws = workspaces[worker];
+			for (unsigned int i = inicio; i < fim; i++) {
+				unsigned int s = rotas.getIndex(pedidos[i].origem);
+				unsigned int t = rotas.getIndex(pedidos[i].destino);
+				res[i].custo = SearchWorkspace<float>::infinity();
+				if (s == rotas.NO_VERTEX || t == rotas.NO_VERTEX)
+					continue;
+
+				if (aStar)
+					res[i].custo = rotas.aStar(s, t,
+							haversineHeuristic(pontos, rotas.getInfo(t)), ws);
+				else
+					res[i].custo = rotas.dijkstra(s, t, ws);
+				res[i].caminho = rotas.getPath(s, t, ws);
+			}
+		});
+	}
+	pool.wait();
+	return res;
+}
+
+/**
+ * @brief Writes the results of a batch, one line per query: "origin;destination;cost;node node ...",
+ * with the node ids of the map files.
+ * Unreachable destinations have cost "inf" and no nodes.
+ * @param ids the node ids of the map, from abrirMapa
+ */
+void writeRouteResults(const string& ficheiro,
+		const vector<RouteQuery>& pedidos, const vector<RouteResult>& resultados,
+		const NodeIdMap& ids) {
+	ofstream outFile(ficheiro.c_str());
+	if (!outFile.is_open())
+		throw(exception());
+
+	for (unsigned int i = 0; i < pedidos.size(); i++) {
+		outFile << pedidos[i].idOrigem << ";" << pedidos[i].idDestino << ";";
+		if (resultados[i].caminho.empty())
+			outFile << "inf;";
+		else
+			outFile << resultados[i].custo << ";";
+		for (unsigned int j = 0; j < resultados[i].caminho.size(); j++) {
+			if (j > 0)
+				outFile << " ";
+			outFile << ids.getOriginalId(resultados[i].caminho[j].idNo);
+			if (resultados[i].caminho[j].layer != ' ')
+				outFile << resultados[i].caminho[j].layer;
+		}
+		outFile << "\n";
+	}
+}
+
+/**
+ * @brief Runs the same batch with 1 up to maxThreads threads and prints the throughput of each run.
+ * @return the results of the last run
+ */
+vector<RouteResult> testBatchThroughput(const FrozenGraph<NoInfo>& rotas,
+		const vector<RouteQuery>& pedidos, const string& algoritmo,
+		unsigned int maxThreads) {
+	vector<RouteResult> resultados;
+	double base = 0;
+
+	for (unsigned int n = 1; n <= maxThreads; n++) {
+		ThreadPool pool(n);
+		auto start = std::chrono::high_resolution_clock::now();
+		resultados = runRouteQueries(rotas, pedidos, algoritmo, pool);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double segundos =
+				(double) std::chrono::duration_cast<std::chrono::microseconds>(
+						end - start).count() / 1000000;
+		double debito = segundos > 0 ? pedidos.size() / segundos : 0;
+		if (n == 1)
+			base = debito;
+
+		cout << "THREADS " << n << " : " << debito << " pedidos/s";
+		if (base > 0)
+			cout << " (x" << debito / base << ")";
+		cout << endl;
+	}
+	return resultados;
+}
+
+#endif /* SRC_BATCHQUERIES_H_ */
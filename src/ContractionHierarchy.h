@@ -0,0 +1,399 @@
+/*
+ * ContractionHierarchy.h
+ */
+#ifndef SRC_CONTRACTIONHIERARCHY_H_
+#define SRC_CONTRACTIONHIERARCHY_H_
+
+#include <vector>
+#include <list>
+#include "FrozenGraph.h"
+#include "IndexedHeap.h"
+#include "SearchWorkspace.h"
+
+using namespace std;
+
+#define CH_LIMITE_WITNESS 200 //vertices fixados, no maximo, por cada witness search
+
+/** @file */
+
+/**
+ * Contraction Hierarchies over a routing snapshot.
+ *
+ * Preprocessing contracts the vertices one at a time, by increasing edge difference (shortcuts added
+ * minus edges removed, plus the number of neighbours already contracted). Contracting v adds a
+ * shortcut u->w, through v, for every pair of neighbours whose shortest path goes through v; a local
+ * Dijkstra from u without v (the witness search) proves when it does not. The order in which the
+ * vertices were contracted is their rank.
+ *
+ * A query is a bidirectional Dijkstra where the forward search only goes up (to higher ranks) and the
+ * backward search only comes down, so both settle very few vertices. Shortcuts keep the vertex they
+ * skip, so the path can be unpacked back into edges of the original graph.
+ */
+template<class T>
+class ContractionHierarchy {
+	const FrozenGraph<T> * grafo;
+	vector<unsigned int> rank;
+	unsigned int numShortcuts;
+
+	//arestas para vertices de rank maior, guardadas na origem
+	vector<unsigned int> upOffsets;
+	vector<unsigned int> upTargets;
+	vector<float> upWeights;
+	vector<unsigned int> upMiddles;
+	//arestas vindas de vertices de rank maior, guardadas no destino
+	vector<unsigned int> downOffsets;
+	vector<unsigned int> downSources;
+	vector<float> downWeights;
+	vector<unsigned int> downMiddles;
+
+	struct Arco {
+		unsigned int outro;
+		float peso;
+		unsigned int meio;
+		Arco(unsigned int outro, float peso, unsigned int meio) :
+				outro(outro), peso(peso), meio(meio) {
+		}
+	};
+
+	void addArco(vector<vector<Arco> > &out, vector<vector<Arco> > &in,
+			unsigned int u, unsigned int w, float peso, unsigned int meio);
+	int contract(unsigned int v, bool simular, vector<vector<Arco> > &out,
+			vector<vector<Arco> > &in, const vector<bool> &contraido,
+			SearchWorkspace<float> &ws);
+	unsigned int middleOf(unsigned int a, unsigned int b) const;
+	void unpack(unsigned int a, unsigned int b, list<unsigned int> &res) const;
+public:
+	static const unsigned int NO_VERTEX = UINT_MAX;
+
+	ContractionHierarchy(const FrozenGraph<T> &grafo);
+
+	unsigned int getNumShortcuts() const {
+		return numShortcuts;
+	}
+	unsigned int getRank(unsigned int v) const {
+		return rank[v];
+	}
+
+	float query(unsigned int s, unsigned int t, SearchWorkspace<float> &forward,
+			SearchWorkspace<float> &backward, unsigned int &meio) const;
+	vector<T> getCHPath(const T &origin, const T &dest,
+			SearchWorkspace<float> &forward,
+			SearchWorkspace<float> &backward) const;
+};
+
+template<class T>
+const unsigned int ContractionHierarchy<T>::NO_VERTEX;
+
+/**
+ * @brief Adds the arc u->w, or lowers its weight if it already exists (keeps one arc per pair).
+ */
+template<class T>
+void ContractionHierarchy<T>::addArco(vector<vector<Arco> > &out,
+		vector<vector<Arco> > &in, unsigned int u, unsigned int w, float peso,
+		unsigned int meio) {
+	for (unsigned int i = 0; i < out[u].size(); i++) {
+		if (out[u][i].outro == w) {
+			if (peso < out[u][i].peso) {
+				out[u][i].peso = peso;
+				out[u][i].meio = meio;
+				for (unsigned int j = 0; j < in[w].size(); j++)
+					if (in[w][j].outro == u) {
+						in[w][j].peso = peso;
+						in[w][j].meio = meio;
+					}
+			}
+			return;
+		}
+	}
+	out[u].push_back(Arco(w, peso, meio));
+	in[w].push_back(Arco(u, peso, meio));
+}
+
+/**
+ * @brief Contracts v (or only counts the shortcuts it would need, if simular is true).
+ * @return the edge difference: shortcuts needed minus arcs removed
+ */
+template<class T>
+int ContractionHierarchy<T>::contract(unsigned int v, bool simular,
+		vector<vector<Arco> > &out, vector<vector<Arco> > &in,
+		const vector<bool> &contraido, SearchWorkspace<float> &ws) {
+	int atalhos = 0;
+	float maxSaida = 0;
+	for (unsigned int j = 0; j < out[v].size(); j++)
+		if (out[v][j].peso > maxSaida)
+			maxSaida = out[v][j].peso;
+
+	for (unsigned int i = 0; i < in[v].size(); i++) {
+		unsigned int u = in[v][i].outro;
+		float pesoUV = in[v][i].peso;
+		float limite = pesoUV + maxSaida;
+
+		//witness search: dijkstra local a partir de u, sem passar por v
+		ws.beginQuery(out.size());
+		IndexedHeap<float> &q = ws.getQueue();
+		ws.setDist(u, 0, NO_VERTEX);
+		q.insert(u, 0);
+		unsigned int fixados = 0;
+		while (!q.empty() && fixados < CH_LIMITE_WITNESS) {
+			unsigned int x = q.extractMin();
+			float dx = ws.getDist(x);
+			if (dx > limite)
+				break;
+			fixados++;
+			for (unsigned int k = 0; k < out[x].size(); k++) {
+				unsigned int y = out[x][k].outro;
+				if (y == v || contraido[y])
+					continue;
+				float nova = dx + out[x][k].peso;
+				if (nova < ws.getDist(y)) {
+					ws.setDist(y, nova, x);
+					q.insertOrDecrease(y, nova);
+				}
+			}
+		}
+
+		for (unsigned int j = 0; j < out[v].size(); j++) {
+			unsigned int w = out[v][j].outro;
+			if (w == u)
+				continue;
+			float via = pesoUV + out[v][j].peso;
+			if (ws.getDist(w) > via) {
+				atalhos++;
+				if (!simular)
+					addArco(out, in, u, w, via, v);
+			}
+		}
+	}
+	return atalhos - (int) (in[v].size() + out[v].size());
+}
+
+/**
+ * @brief Builds the hierarchy (runs the whole preprocessing).
+ * @param grafo the routing snapshot; it must outlive the hierarchy
+ */
+template<class T>
+ContractionHierarchy<T>::ContractionHierarchy(const FrozenGraph<T> &grafo) :
+		grafo(&grafo), numShortcuts(0) {
+	unsigned int n = grafo.getNumVertex();
+	vector<vector<Arco> > out(n), in(n);
+	for (unsigned int v = 0; v < n; v++)
+		for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++)
+			if (grafo.getTarget(e) != v)
+				addArco(out, in, v, grafo.getTarget(e), grafo.getWeight(e),
+						NO_VERTEX);
+
+	vector<vector<Arco> > up(n), down(n);
+	vector<bool> contraido(n, false);
+	vector<int> vizinhosContraidos(n, 0);
+	SearchWorkspace<float> ws;
+	rank.assign(n, 0);
+
+	//ordem inicial pela diferenca de arestas
+	IndexedHeap<int> ordem(n);
+	for (unsigned int v = 0; v < n; v++)
+		ordem.insert(v, contract(v, true, out, in, contraido, ws));
+
+	unsigned int proximo = 0;
+	while (!ordem.empty()) {
+		unsigned int v = ordem.extractMin();
+
+		//lazy update: se a prioridade piorou e ja nao e a menor, volta para a fila
+		int prioridade = contract(v, true, out, in, contraido, ws)
+				+ vizinhosContraidos[v];
+		if (!ordem.empty() && prioridade > ordem.minKey()) {
+			ordem.insert(v, prioridade);
+			continue;
+		}
+
+		contract(v, false, out, in, contraido, ws);
+
+		//as arestas que restam a v ligam-no a vertices de rank maior
+		up[v] = out[v];
+		down[v] = in[v];
+		contraido[v] = true;
+		rank[v] = proximo++;
+
+		for (unsigned int j = 0; j < out[v].size(); j++) {
+			unsigned int w = out[v][j].outro;
+			for (unsigned int k = 0; k < in[w].size(); k++)
+				if (in[w][k].outro == v) {
+					in[w].erase(in[w].begin() + k);
+					break;
+				}
+			vizinhosContraidos[w]++;
+		}
+		for (unsigned int i = 0; i < in[v].size(); i++) {
+			unsigned int u = in[v][i].outro;
+			for (unsigned int k = 0; k < out[u].size(); k++)
+				if (out[u][k].outro == v) {
+					out[u].erase(out[u].begin() + k);
+					break;
+				}
+			vizinhosContraidos[u]++;
+		}
+		out[v].clear();
+		in[v].clear();
+	}
+
+	//CSR das duas metades da hierarquia
+	upOffsets.push_back(0);
+	downOffsets.push_back(0);
+	for (unsigned int v = 0; v < n; v++) {
+		for (unsigned int j = 0; j < up[v].size(); j++) {
+			upTargets.push_back(up[v][j].outro);
+			upWeights.push_back(up[v][j].peso);
+			upMiddles.push_back(up[v][j].meio);
+			if (up[v][j].meio != NO_VERTEX)
+				numShortcuts++;
+		}
+		for (unsigned int j = 0; j < down[v].size(); j++) {
+			downSources.push_back(down[v][j].outro);
+			downWeights.push_back(down[v][j].peso);
+			downMiddles.push_back(down[v][j].meio);
+			if (down[v][j].meio != NO_VERTEX)
+				numShortcuts++;
+		}
+		upOffsets.push_back(upTargets.size());
+		downOffsets.push_back(downSources.size());
+	}
+}
+
+/**
+ * @return the vertex skipped by the arc a->b of the hierarchy (NO_VERTEX if it is an original edge)
+ */
+template<class T>
+unsigned int ContractionHierarchy<T>::middleOf(unsigned int a,
+		unsigned int b) const {
+	if (rank[a] < rank[b]) {
+		for (unsigned int e = upOffsets[a]; e < upOffsets[a + 1]; e++)
+			if (upTargets[e] == b)
+				return upMiddles[e];
+	} else {
+		for (unsigned int e = downOffsets[b]; e < downOffsets[b + 1]; e++)
+			if (downSources[e] == a)
+				return downMiddles[e];
+	}
+	return NO_VERTEX;
+}
+
+/**
+ * @brief Appends to res the vertices of the original path a->b, without a.
+ */
+template<class T>
+void ContractionHierarchy<T>::unpack(unsigned int a, unsigned int b,
+		list<unsigned int> &res) const {
+	unsigned int meio = middleOf(a, b);
+	if (meio == NO_VERTEX) {
+		res.push_back(b);
+		return;
+	}
+	unpack(a, meio, res);
+	unpack(meio, b, res);
+}
+
+/**
+ * @brief Bidirectional upward search from s and t. Each direction stops once its smallest key
+ * is not below the best distance found.
+ * @param meio the vertex where the best forward and backward paths meet (NO_VERTEX if none)
+ * @return the distance from s to t (infinity if t is unreachable)
+ */
+template<class T>
+float ContractionHierarchy<T>::query(unsigned int s, unsigned int t,
+		SearchWorkspace<float> &forward, SearchWorkspace<float> &backward,
+		unsigned int &meio) const {
+	unsigned int n = rank.size();
+	forward.beginQuery(n);
+	backward.beginQuery(n);
+	IndexedHeap<float> &fq = forward.getQueue();
+	IndexedHeap<float> &bq = backward.getQueue();
+	forward.setDist(s, 0, NO_VERTEX);
+	fq.insert(s, 0);
+	backward.setDist(t, 0, NO_VERTEX);
+	bq.insert(t, 0);
+
+	float melhor = SearchWorkspace<float>::infinity();
+	meio = NO_VERTEX;
+
+	while (true) {
+		bool frente = !fq.empty() && fq.minKey() < melhor;
+		bool tras = !bq.empty() && bq.minKey() < melhor;
+		if (!frente && !tras)
+			break;
+
+		if (frente && (!tras || fq.minKey() <= bq.minKey())) {
+			unsigned int v = fq.extractMin();
+			forward.countSettled();
+			float dv = forward.getDist(v);
+			if (backward.reached(v) && dv + backward.getDist(v) < melhor) {
+				melhor = dv + backward.getDist(v);
+				meio = v;
+			}
+			for (unsigned int e = upOffsets[v]; e < upOffsets[v + 1]; e++) {
+				unsigned int w = upTargets[e];
+				float nova = dv + upWeights[e];
+				if (nova < forward.getDist(w)) {
+					forward.setDist(w, nova, v);
+					fq.insertOrDecrease(w, nova);
+				}
+			}
+		} else {
+			unsigned int v = bq.extractMin();
+			backward.countSettled();
+			float dv = backward.getDist(v);
+			if (forward.reached(v) && dv + forward.getDist(v) < melhor) {
+				melhor = dv + forward.getDist(v);
+				meio = v;
+			}
+			for (unsigned int e = downOffsets[v]; e < downOffsets[v + 1];
+					e++) {
+				unsigned int u = downSources[e];
+				float nova = dv + downWeights[e];
+				if (nova < backward.getDist(u)) {
+					backward.setDist(u, nova, v);
+					bq.insertOrDecrease(u, nova);
+				}
+			}
+		}
+	}
+	return melhor;
+}
+
+/**
+ * @brief Shortest path between two vertices, unpacked into vertices of the original graph.
+ * @return the path, or an empty vector if there is none
+ */
+template<class T>
+vector<T> ContractionHierarchy<T>::getCHPath(const T &origin, const T &dest,
+		SearchWorkspace<float> &forward,
+		SearchWorkspace<float> &backward) const {
+	vector<T> res;
+	unsigned int s = grafo->getIndex(origin), t = grafo->getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return res;
+
+	unsigned int meio;
+	query(s, t, forward, backward, meio);
+	if (meio == NO_VERTEX)
+		return res;
+
+	//caminho na hierarquia: s .. meio pela frente, meio .. t por tras
+	list<unsigned int> hierarquia;
+	for (unsigned int v = meio; v != NO_VERTEX; v = forward.getPath(v))
+		hierarquia.push_front(v);
+	for (unsigned int v = backward.getPath(meio); v != NO_VERTEX; v =
+			backward.getPath(v))
+		hierarquia.push_back(v);
+
+	list<unsigned int> caminho;
+	caminho.push_back(s);
+	list<unsigned int>::const_iterator it = hierarquia.begin();
+	list<unsigned int>::const_iterator anterior = it++;
+	for (; it != hierarquia.end(); anterior = it++)
+		unpack(*anterior, *it, caminho);
+
+	for (it = caminho.begin(); it != caminho.end(); it++)
+		res.push_back(grafo->getInfo(*it));
+	return res;
+}
+
+#endif /* SRC_CONTRACTIONHIERARCHY_H_ */
@@ -0,0 +1,190 @@
+/*
+ * DeltaStepping.h
+ */
+#ifndef SRC_DELTASTEPPING_H_
+#define SRC_DELTASTEPPING_H_
+
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include "FrozenGraph.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+#define DS_MINIMO_PARALELO 256 //vertices abaixo dos quais uma fase corre sem threads
+#define DS_TAREFAS_POR_THREAD 4 //blocos de cada fase por thread, para equilibrar a carga
+#define DS_FATOR_DELTA 10 //largura dos baldes, em grau medio x peso mediano
+
+/** @file */
+
+/**
+ * @brief Float distances as unsigned ints: for floats >= 0 (and infinity) the order of the bit patterns
+ * is the order of the values, so an atomic min is a compare-and-swap on the integer.
+ */
+inline unsigned int deltaSteppingBits(float valor) {
+	unsigned int bits;
+	memcpy(&bits, &valor, sizeof(bits));
+	return bits;
+}
+
+inline float deltaSteppingValue(unsigned int bits) {
+	float valor;
+	memcpy(&valor, &bits, sizeof(valor));
+	return valor;
+}
+
+/**
+ * @brief Lowers alvo to valor if it is smaller.
+ * @return true if this call lowered it
+ */
+inline bool deltaSteppingMin(atomic<unsigned int> &alvo, float valor) {
+	unsigned int novo = deltaSteppingBits(valor);
+	unsigned int atual = alvo.load(memory_order_relaxed);
+	while (novo < atual)
+		if (alvo.compare_exchange_weak(atual, novo, memory_order_relaxed))
+			return true;
+	return false;
+}
+
+/**
+ * @brief Bucket width for deltaStepping, from the weights of the graph: DS_FATOR_DELTA times the
+ * average degree times the median of the positive weights. On the city maps this keeps the vertices
+ * relaxed more than once to about half, with phases of a few dozen vertices on average; wider buckets
+ * give larger phases but re-relax most vertices several times.
+ */
+template<class T>
+float deltaSteppingWidth(const FrozenGraph<T> &grafo) {
+	vector<float> positivos;
+	for (unsigned int e = 0; e < grafo.getNumEdges(); e++)
+		if (grafo.getWeight(e) > 0)
+			positivos.push_back(grafo.getWeight(e));
+	if (positivos.empty())
+		return 1;
+	nth_element(positivos.begin(), positivos.begin() + positivos.size() / 2,
+			positivos.end());
+	return DS_FATOR_DELTA * positivos[positivos.size() / 2]
+			* grafo.getNumEdges() / grafo.getNumVertex();
+}
+
+/**
+ * @brief Relaxes the light (w <= delta) or heavy edges of lista[inicio, fim), adding the vertices whose
+ * distance went down to pedidos.
+ */
+template<class T>
+void deltaSteppingRelax(const FrozenGraph<T> &grafo,
+		const vector<unsigned int> &lista, unsigned int inicio, unsigned int fim,
+		bool leves, float delta, atomic<unsigned int> *dist,
+		vector<unsigned int> &pedidos) {
+	for (unsigned int i = inicio; i < fim; i++) {
+		unsigned int v = lista[i];
+		float dv = deltaSteppingValue(dist[v].load(memory_order_relaxed));
+		for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++) {
+			float peso = grafo.getWeight(e);
+			if ((peso <= delta) != leves)
+				continue;
+			unsigned int w = grafo.getTarget(e);
+			if (deltaSteppingMin(dist[w], dv + peso))
+				pedidos.push_back(w);
+		}
+	}
+}
+
+/**
+ * @brief One-to-all shortest distances by delta-stepping.
+ * The vertices are kept in buckets of width delta by tentative distance. The smallest bucket is emptied
+ * in phases: each phase relaxes the light edges of the whole bucket at once, in parallel, which may put
+ * vertices back in it; once it stays empty, the heavy edges of every vertex it held are relaxed, also
+ * in parallel (they can only reach later buckets). Distances are lowered with an atomic min, so threads
+ * never lock; the vertices each thread improves are put in their new buckets between phases.
+ * The result is the fixed point of dist[w] = min(dist[v] + w(v,w)), the same as Dijkstra's.
+ * @param s the source vertex
+ * @param delta bucket width (see deltaSteppingWidth)
+ * @param pool the threads; phases with fewer than DS_MINIMO_PARALELO vertices run on the calling thread
+ * @param dist output, one position per vertex (infinity for the unreachable ones)
+ */
+template<class T>
+void deltaStepping(const FrozenGraph<T> &grafo, unsigned int s, float delta,
+		ThreadPool &pool, vector<float> &dist) {
+	unsigned int n = grafo.getNumVertex();
+	vector<atomic<unsigned int> > atomicas(n);
+	unsigned int infinito = deltaSteppingBits(numeric_limits<float>::infinity());
+	for (unsigned int v = 0; v < n; v++)
+		atomicas[v].store(infinito, memory_order_relaxed);
+	atomic<unsigned int> *d = n > 0 ? &atomicas[0] : NULL;
+
+	vector<vector<unsigned int> > baldes(1);
+	vector<vector<unsigned int> > pedidos(pool.size());
+	vector<unsigned int> fase(n, UINT_MAX); //ultima fase em que o vertice foi relaxado
+	vector<unsigned int> removido(n, UINT_MAX); //ultimo balde de onde o vertice saiu
+	vector<unsigned int> atual, retirados;
+	unsigned int numFase = 0;
+	if (s < n) {
+		d[s].store(deltaSteppingBits(0), memory_order_relaxed);
+		baldes[0].push_back(s);
+	}
+
+	//relaxa lista (arestas leves ou pesadas) e poe nos baldes os vertices que melhoraram
+	auto relaxar = [&](const vector<unsigned int> &lista, bool leves) {
+		if (lista.size() < DS_MINIMO_PARALELO || pool.size() == 1)
+			deltaSteppingRelax(grafo, lista, 0, lista.size(), leves, delta, d,
+					pedidos[0]);
+		else {
+			unsigned int blocos = pool.size() * DS_TAREFAS_POR_THREAD;
+			unsigned int tamanho = (lista.size() + blocos - 1) / blocos;
+			for (unsigned int inicio = 0; inicio < lista.size(); inicio += tamanho) {
+				unsigned int fim = inicio + tamanho < lista.size() ?
+						inicio + tamanho : lista.size();
+				pool.submit([&, inicio, fim, leves](unsigned int worker) {
+					deltaSteppingRelax(grafo, lista, inicio, fim, leves, delta, d,
+							pedidos[worker]);
+				});
+			}
+			pool.wait();
+		}
+		for (unsigned int t = 0; t < pedidos.size(); t++) {
+			for (unsigned int i = 0; i < pedidos[t].size(); i++) {
+				unsigned int w = pedidos[t][i];
+				size_t b = (size_t) (deltaSteppingValue(
+						d[w].load(memory_order_relaxed)) / delta);
+				if (b >= baldes.size())
+					baldes.resize(b + 1);
+				baldes[b].push_back(w);
+			}
+			pedidos[t].clear();
+		}
+	};
+
+	for (unsigned int i = 0; i < baldes.size(); i++) {
+		retirados.clear();
+		while (!baldes[i].empty()) {
+			//so conta a entrada mais recente de cada vertice que ainda pertence a este balde
+			atual.clear();
+			for (unsigned int j = 0; j < baldes[i].size(); j++) {
+				unsigned int v = baldes[i][j];
+				if (fase[v] == numFase
+						|| (size_t) (deltaSteppingValue(
+								d[v].load(memory_order_relaxed)) / delta) != i)
+					continue;
+				fase[v] = numFase;
+				atual.push_back(v);
+				if (removido[v] != i) {
+					removido[v] = i;
+					retirados.push_back(v);
+				}
+			}
+			baldes[i].clear();
+			numFase++;
+			relaxar(atual, true);
+		}
+		relaxar(retirados, false);
+	}
+
+	dist.resize(n);
+	for (unsigned int v = 0; v < n; v++)
+		dist[v] = deltaSteppingValue(d[v].load(memory_order_relaxed));
+}
+
+#endif /* SRC_DELTASTEPPING_H_ */
@@ -0,0 +1,181 @@
+/*
+ * FloydWarshall.h
+ */
+#ifndef SRC_FLOYDWARSHALL_H_
+#define SRC_FLOYDWARSHALL_H_
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <limits.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "ThreadPool.h"
+
+using namespace std;
+
+#define FW_BLOCO 64 //lado de cada bloco, em elementos (multiplo de 4 para o SSE2)
+#define FW_SEM_CAMINHO (INT_MAX / 2) //numero de arestas de um par sem caminho (a soma de dois nao transborda)
+#define FW_BITS_FRACAO 20 //pesos arredondados a multiplos de 2^-20 horas (~3.4 ms)
+
+/** @file */
+
+/**
+ * @brief Rounds the number of vertices up to a whole number of blocks. The matrices used by
+ * floydWarshallBlocked have this many rows and columns; the extra ones stay at infinity.
+ */
+inline unsigned int floydWarshallStride(unsigned int numVertex) {
+	return (numVertex + FW_BLOCO - 1) / FW_BLOCO * FW_BLOCO;
+}
+
+/**
+ * @brief Rounds a weight to a multiple of 2^-FW_BITS_FRACAO. Sums of such floats are exact (while
+ * below 2^(24-FW_BITS_FRACAO) = 16 hours), so the distances do not depend on the order in which the
+ * blocks add them up, and every distance is exactly the sum of the weights of its path.
+ */
+inline float floydWarshallWeight(long double peso) {
+	return (float) ldexp(floor(ldexp(peso, FW_BITS_FRACAO) + 0.5),
+			-FW_BITS_FRACAO);
+}
+
+/**
+ * @brief Relaxes block (bi, bj) through the intermediate vertices of block bk, in order:
+ * dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]). Ties in distance are broken by the number
+ * of edges (arestas), so that every path has a predecessor with fewer edges even with the zero weight
+ * transfers between layers (see floydWarshallPredecessors).
+ * The j loop is a min-plus over contiguous floats, done 4 at a time with SSE2 when available.
+ * Block (bi, bj) may be the same as (bi, bk) or (bk, bj): as dist[k][k] is never negative, the row
+ * or column being read is never changed by the step that reads it.
+ */
+inline void floydWarshallBlock(float *dist, int *arestas, unsigned int stride,
+		unsigned int bi, unsigned int bj, unsigned int bk) {
+	unsigned int i0 = bi * FW_BLOCO, j0 = bj * FW_BLOCO, k0 = bk * FW_BLOCO;
+	for (unsigned int k = k0; k < k0 + FW_BLOCO; k++) {
+		const float *linhaK = dist + (size_t) k * stride + j0;
+		const int *arestasK = arestas + (size_t) k * stride + j0;
+		for (unsigned int i = i0; i < i0 + FW_BLOCO; i++) {
+			float dik = dist[(size_t) i * stride + k];
+			if (dik == numeric_limits<float>::infinity())
+				continue;
+			int aik = arestas[(size_t) i * stride + k];
+			float *linhaI = dist + (size_t) i * stride + j0;
+			int *arestasI = arestas + (size_t) i * stride + j0;
+#ifdef __SSE2__
+			__m128 vik = _mm_set1_ps(dik);
+			__m128i vaik = _mm_set1_epi32(aik);
+			for (unsigned int j = 0; j < FW_BLOCO; j += 4) {
+				__m128 nova = _mm_add_ps(vik, _mm_loadu_ps(linhaK + j));
+				__m128 atual = _mm_loadu_ps(linhaI + j);
+				__m128i novaA = _mm_add_epi32(vaik,
+						_mm_loadu_si128((const __m128i *) (arestasK + j)));
+				__m128i atualA = _mm_loadu_si128((const __m128i *) (arestasI + j));
+				__m128i mascara = _mm_or_si128(
+						_mm_castps_si128(_mm_cmplt_ps(nova, atual)),
+						_mm_and_si128(_mm_castps_si128(_mm_cmpeq_ps(nova, atual)),
+								_mm_cmplt_epi32(novaA, atualA)));
+				if (_mm_movemask_epi8(mascara) == 0)
+					continue;
+				_mm_storeu_ps(linhaI + j, _mm_min_ps(nova, atual));
+				_mm_storeu_si128((__m128i *) (arestasI + j),
+						_mm_or_si128(_mm_and_si128(mascara, novaA),
+								_mm_andnot_si128(mascara, atualA)));
+			}
+#else
+			for (unsigned int j = 0; j < FW_BLOCO; j++) {
+				float nova = dik + linhaK[j];
+				int novaA = aik + arestasK[j];
+				if (nova < linhaI[j]
+						|| (nova == linhaI[j] && novaA < arestasI[j])) {
+					linhaI[j] = nova;
+					arestasI[j] = novaA;
+				}
+			}
+#endif
+		}
+	}
+}
+
+/**
+ * @brief Blocked Floyd-Warshall over stride x stride row-major matrices.
+ * For each diagonal block k: (1) the block (k,k) itself, (2) the rest of row k and column k, which
+ * only depend on (k,k), in parallel, (3) every other block, which only depends on its row and column
+ * blocks from (2), in parallel, one task per row of blocks.
+ * @param dist distances, initialised with the edge weights (see floydWarshallWeight; 0 on the diagonal,
+ * infinity if there is no edge)
+ * @param arestas number of edges of each path, initialised with 1 (0 on the diagonal, FW_SEM_CAMINHO if there is no edge)
+ * @param stride matrix side, a multiple of FW_BLOCO (see floydWarshallStride)
+ * @param pool the threads that process the blocks of phases 2 and 3
+ */
+inline void floydWarshallBlocked(float *dist, int *arestas, unsigned int stride,
+		ThreadPool &pool) {
+	unsigned int blocos = stride / FW_BLOCO;
+
+	for (unsigned int k = 0; k < blocos; k++) {
+		floydWarshallBlock(dist, arestas, stride, k, k, k);
+
+		for (unsigned int b = 0; b < blocos; b++) {
+			if (b == k)
+				continue;
+			pool.submit([=](unsigned int) {
+				floydWarshallBlock(dist, arestas, stride, k, b, k);
+				floydWarshallBlock(dist, arestas, stride, b, k, k);
+			});
+		}
+		pool.wait();
+
+		for (unsigned int i = 0; i < blocos; i++) {
+			if (i == k)
+				continue;
+			pool.submit([=](unsigned int) {
+				for (unsigned int j = 0; j < blocos; j++)
+					if (j != k)
+						floydWarshallBlock(dist, arestas, stride, i, j, k);
+			});
+		}
+		pool.wait();
+	}
+}
+
+/**
+ * @brief Fills the predecessor matrix from the final distances. The predecessor of j (from i) is the
+ * vertex p, among those with an edge p->j and a path from i that is shorter than j's (or as short, with
+ * fewer edges), that minimizes dist[i][p] + w(p,j). (distance, edges) always goes down along the
+ * predecessors, so they can be followed back to i without ever going around in circles.
+ * Predecessors can not simply be carried along in the blocked loop (prec[i][j] = prec[k][j]): the
+ * blocks read rows of other blocks that are further ahead, and the copied predecessor may not match.
+ * @param entradas for each vertex, the edges that arrive to it: (source, weight as in dist)
+ * @param prec output, NO_VERTEX (UINT_MAX) where there is no path
+ */
+inline void floydWarshallPredecessors(const float *dist, const int *arestas,
+		unsigned int stride, const vector<vector<pair<unsigned int, float> > > &entradas,
+		unsigned int *prec, ThreadPool &pool) {
+	unsigned int n = entradas.size();
+	for (unsigned int i = 0; i < n; i++) {
+		pool.submit([=, &entradas](unsigned int) {
+			const float *linha = dist + (size_t) i * stride;
+			const int *linhaA = arestas + (size_t) i * stride;
+			unsigned int *linhaP = prec + (size_t) i * stride;
+			for (unsigned int j = 0; j < n; j++) {
+				linhaP[j] = UINT_MAX;
+				if (j == i || linha[j] == numeric_limits<float>::infinity())
+					continue;
+				float melhor = numeric_limits<float>::infinity();
+				for (unsigned int e = 0; e < entradas[j].size(); e++) {
+					unsigned int p = entradas[j][e].first;
+					float via = linha[p] + entradas[j][e].second;
+					bool antes = linha[p] < linha[j]
+							|| (linha[p] == linha[j] && linhaA[p] < linhaA[j]);
+					if (antes && via < melhor) {
+						melhor = via;
+						linhaP[j] = p;
+					}
+				}
+			}
+		});
+	}
+	pool.wait();
+}
+
+#endif /* SRC_FLOYDWARSHALL_H_ */
@@ -0,0 +1,579 @@
+/*
+ * FrozenGraph.h
+ */
+#ifndef SRC_FROZENGRAPH_H_
+#define SRC_FROZENGRAPH_H_
+
+#include <vector>
+#include <queue>
+#include <list>
+#include <limits>
+#include <unordered_map>
+#include "Graph.h"
+#include "IndexedHeap.h"
+#include "SearchWorkspace.h"
+#include "RadixHeap.h"
+
+using namespace std;
+
+#define UNIDADES_POR_HORA 36000 //pesos inteiros em decimas de segundo
+
+/** @file */
+
+/**
+ * Heuristic that always returns 0. Using it in FrozenGraph::aStar gives Dijkstra's algorithm.
+ */
+struct noHeuristic {
+	float operator()(unsigned int) const {
+		return 0;
+	}
+};
+
+/**
+ * Immutable routing snapshot of a Graph, in compressed sparse row (CSR) format.
+ * Vertices are numbered 0..n-1 (their position in the vertexSet at the time of freeze()).
+ * The edges leaving vertex v are the positions offsets[v]..offsets[v+1]-1 of the targets,
+ * weights and edgeIds arrays, so searches read the adjacency of a vertex from contiguous memory.
+ * Vertex information (T) is kept apart and is only needed to translate the results.
+ * The same edges are also kept grouped by target (reverse adjacency, revOffsets..), so a search
+ * can go backwards from the destination.
+ * Optionally (see quantize()), the weights are also kept as integers, for radixDijkstra.
+ */
+template<class T>
+class FrozenGraph {
+	vector<unsigned int> offsets;
+	vector<unsigned int> targets;
+	vector<float> weights;
+	vector<unsigned long long> edgeIds;
+	vector<unsigned int> revOffsets;
+	vector<unsigned int> revSources;
+	vector<float> revWeights;
+	vector<unsigned int> quantWeights;
+	unsigned int unitsPerHour;
+	vector<T> infos;
+	unordered_map<T, unsigned int> index;
+
+	void buildReverse();
+
+	template<class U, class W> friend class Graph;
+public:
+	static const unsigned int NO_VERTEX = UINT_MAX;
+
+	FrozenGraph() :
+			unitsPerHour(0) {
+	}
+
+	unsigned int getNumVertex() const {
+		return infos.size();
+	}
+	unsigned int getNumEdges() const {
+		return targets.size();
+	}
+	size_t getMemoryBytes() const;
+	const T& getInfo(unsigned int v) const {
+		return infos[v];
+	}
+	unsigned int getIndex(const T &info) const;
+
+	unsigned int edgesBegin(unsigned int v) const {
+		return offsets[v];
+	}
+	unsigned int edgesEnd(unsigned int v) const {
+		return offsets[v + 1];
+	}
+	unsigned int getTarget(unsigned int e) const {
+		return targets[e];
+	}
+	float getWeight(unsigned int e) const {
+		return weights[e];
+	}
+	unsigned long long getEdgeId(unsigned int e) const {
+		return edgeIds[e];
+	}
+
+	unsigned int revEdgesBegin(unsigned int v) const {
+		return revOffsets[v];
+	}
+	unsigned int revEdgesEnd(unsigned int v) const {
+		return revOffsets[v + 1];
+	}
+	unsigned int getSource(unsigned int e) const {
+		return revSources[e];
+	}
+	float getRevWeight(unsigned int e) const {
+		return revWeights[e];
+	}
+
+	void quantize(unsigned int unidadesPorHora = UNIDADES_POR_HORA);
+	bool isQuantized() const {
+		return quantWeights.size() == targets.size() && unitsPerHour != 0;
+	}
+	unsigned int getUnitsPerHour() const {
+		return unitsPerHour;
+	}
+	unsigned int getQuantWeight(unsigned int e) const {
+		return quantWeights[e];
+	}
+
+	FrozenGraph<T> permuted(const vector<unsigned int> &ordem) const;
+
+	vector<unsigned int> bfs(unsigned int s) const;
+	template<class H>
+	float aStar(unsigned int s, unsigned int t, const H &heuristic,
+			SearchWorkspace<float> &ws) const;
+	float dijkstra(unsigned int s, unsigned int t,
+			SearchWorkspace<float> &ws) const;
+	unsigned int radixDijkstra(unsigned int s, unsigned int t,
+			SearchWorkspace<unsigned int> &ws, RadixHeap &q) const;
+	template<class W>
+	vector<T> getPath(unsigned int s, unsigned int t,
+			const SearchWorkspace<W> &ws) const;
+
+	template<class HF, class HB>
+	float bidirectionalAStar(unsigned int s, unsigned int t,
+			const HF &toTarget, const HB &fromSource,
+			SearchWorkspace<float> &forward, SearchWorkspace<float> &backward,
+			unsigned int &meio) const;
+	float bidirectionalDijkstra(unsigned int s, unsigned int t,
+			SearchWorkspace<float> &forward, SearchWorkspace<float> &backward,
+			unsigned int &meio) const;
+	vector<T> getPath(unsigned int meio, const SearchWorkspace<float> &forward,
+			const SearchWorkspace<float> &backward) const;
+
+	vector<T> getDijkstraPath(const T &origin, const T &dest,
+			SearchWorkspace<float> &ws) const;
+	vector<T> getRadixDijkstraPath(const T &origin, const T &dest,
+			SearchWorkspace<unsigned int> &ws, RadixHeap &q) const;
+	template<class H>
+	vector<T> getA_starPath(const T &origin, const T &dest,
+			const H &heuristic, SearchWorkspace<float> &ws) const;
+	vector<T> getBidirectionalDijkstraPath(const T &origin, const T &dest,
+			SearchWorkspace<float> &forward,
+			SearchWorkspace<float> &backward) const;
+	template<class HF, class HB>
+	vector<T> getBidirectionalA_starPath(const T &origin, const T &dest,
+			const HF &toTarget, const HB &fromSource,
+			SearchWorkspace<float> &forward,
+			SearchWorkspace<float> &backward) const;
+};
+
+template<class T>
+const unsigned int FrozenGraph<T>::NO_VERTEX;
+
+/**
+ * @brief Compiles the graph into an immutable CSR snapshot. Later changes to the graph are not seen by the snapshot.
+ */
+template<class T, class W>
+FrozenGraph<T> Graph<T, W>::freeze() const {
+	FrozenGraph<T> res;
+	res.offsets.reserve(vertexSet.size() + 1);
+	res.targets.reserve(numEdges);
+	res.weights.reserve(numEdges);
+	res.edgeIds.reserve(numEdges);
+	res.infos.reserve(vertexSet.size());
+
+	res.offsets.push_back(0);
+	for (unsigned int i = 0; i < vertexSet.size(); i++) {
+		for (unsigned int j = 0; j < vertexSet[i]->adj.size(); j++) {
+			res.targets.push_back(vertexSet[i]->adj[j].dest->index);
+			res.weights.push_back(
+					WeightTraits<W>::toHours(vertexSet[i]->adj[j].weight));
+			res.edgeIds.push_back(vertexSet[i]->adj[j].id);
+		}
+		res.offsets.push_back(res.targets.size());
+		res.infos.push_back(vertexSet[i]->info);
+		res.index[vertexSet[i]->info] = i;
+	}
+	res.buildReverse();
+	return res;
+}
+
+/**
+ * @brief Builds the reverse adjacency (revOffsets..) from the forward one.
+ */
+template<class T>
+void FrozenGraph<T>::buildReverse() {
+	//conta as arestas que chegam a cada vertice e distribui-as
+	unsigned int n = infos.size();
+	revOffsets.assign(n + 1, 0);
+	revSources.resize(targets.size());
+	revWeights.resize(targets.size());
+	for (unsigned int e = 0; e < targets.size(); e++)
+		revOffsets[targets[e] + 1]++;
+	for (unsigned int v = 0; v < n; v++)
+		revOffsets[v + 1] += revOffsets[v];
+	vector<unsigned int> livre(revOffsets.begin(), revOffsets.end() - 1);
+	for (unsigned int v = 0; v < n; v++)
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+			unsigned int pos = livre[targets[e]]++;
+			revSources[pos] = v;
+			revWeights[pos] = weights[e];
+		}
+}
+
+/**
+ * @brief The same graph with the vertices renumbered: vertex i of the result is vertex ordem[i] of
+ * this one (see VertexOrder.h). The adjacency, the weights (also the quantized ones), the edge ids and
+ * the information of the vertices all follow the new numbering, so vertices that are close in the
+ * new order are also close in memory.
+ * @param ordem a permutation of 0..getNumVertex()-1
+ */
+template<class T>
+FrozenGraph<T> FrozenGraph<T>::permuted(const vector<unsigned int> &ordem) const {
+	unsigned int n = infos.size();
+	vector<unsigned int> posicao(n);
+	for (unsigned int i = 0; i < n; i++)
+		posicao[ordem[i]] = i;
+
+	FrozenGraph<T> res;
+	res.unitsPerHour = unitsPerHour;
+	res.offsets.reserve(n + 1);
+	res.targets.reserve(targets.size());
+	res.weights.reserve(weights.size());
+	res.edgeIds.reserve(edgeIds.size());
+	res.quantWeights.reserve(quantWeights.size());
+	res.infos.reserve(n);
+	res.index.reserve(n);
+	res.offsets.push_back(0);
+	for (unsigned int i = 0; i < n; i++) {
+		unsigned int v = ordem[i];
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+			res.targets.push_back(posicao[targets[e]]);
+			res.weights.push_back(weights[e]);
+			res.edgeIds.push_back(edgeIds[e]);
+			if (isQuantized())
+				res.quantWeights.push_back(quantWeights[e]);
+		}
+		res.offsets.push_back(res.targets.size());
+		res.infos.push_back(infos[v]);
+		res.index[infos[v]] = i;
+	}
+	res.buildReverse();
+	return res;
+}
+
+/**
+ * @return the bytes taken by the snapshot: the adjacency arrays (forward, reverse and quantized), the
+ * information of the vertices and the index by information (not counting the memory that T itself
+ * allocates, such as strings)
+ */
+template<class T>
+size_t FrozenGraph<T>::getMemoryBytes() const {
+	return (offsets.capacity() + targets.capacity() + revOffsets.capacity()
+			+ revSources.capacity() + quantWeights.capacity()) * sizeof(unsigned int)
+			+ (weights.capacity() + revWeights.capacity()) * sizeof(float)
+			+ edgeIds.capacity() * sizeof(unsigned long long)
+			+ infos.capacity() * sizeof(T)
+			+ index.size() * (sizeof(pair<const T, unsigned int>) + sizeof(void *))
+			+ index.bucket_count() * sizeof(void *);
+}
+
+/**
+ * @return the index of the vertex with the given information, or NO_VERTEX if there is none
+ */
+template<class T>
+unsigned int FrozenGraph<T>::getIndex(const T &info) const {
+	typename unordered_map<T, unsigned int>::const_iterator it = index.find(info);
+	if (it == index.end())
+		return NO_VERTEX;
+	return it->second;
+}
+
+/**
+ * @brief Breadth-first search.
+ * @return the indices of the vertices reachable from s, in the order they were visited
+ */
+template<class T>
+vector<unsigned int> FrozenGraph<T>::bfs(unsigned int s) const {
+	vector<unsigned int> res;
+	vector<bool> visited(infos.size(), false);
+	res.reserve(infos.size());
+	res.push_back(s);
+	visited[s] = true;
+	//o proprio vetor de resultado serve de fila
+	for (unsigned int head = 0; head < res.size(); head++) {
+		unsigned int v = res[head];
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+			unsigned int w = targets[e];
+			if (!visited[w]) {
+				visited[w] = true;
+				res.push_back(w);
+			}
+		}
+	}
+	return res;
+}
+
+/**
+ * @brief A* from s to t. The heuristic is called with a vertex index and must return a lower bound
+ * of the distance from that vertex to t.
+ * @param t the destination, or NO_VERTEX to search the whole graph (the distances are left in ws)
+ * @param ws workspace that keeps the distances and the search tree, read by getPath
+ * @return the distance from s to t (infinity if t is unreachable or NO_VERTEX)
+ */
+template<class T>
+template<class H>
+float FrozenGraph<T>::aStar(unsigned int s, unsigned int t, const H &heuristic,
+		SearchWorkspace<float> &ws) const {
+	ws.beginQuery(infos.size());
+	IndexedHeap<float> &q = ws.getQueue();
+	ws.setDist(s, 0, NO_VERTEX);
+	q.insert(s, heuristic(s));
+
+	while (!q.empty()) {
+		unsigned int v = q.extractMin();
+		ws.countSettled();
+		if (v == t)
+			break;
+
+		float dv = ws.getDist(v);
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+			unsigned int w = targets[e];
+			float nova = dv + weights[e];
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v);
+				q.insertOrDecrease(w, nova + heuristic(w));
+			}
+		}
+	}
+	return t == NO_VERTEX ? ws.infinity() : ws.getDist(t);
+}
+
+template<class T>
+float FrozenGraph<T>::dijkstra(unsigned int s, unsigned int t,
+		SearchWorkspace<float> &ws) const {
+	return aStar(s, t, noHeuristic(), ws);
+}
+
+/**
+ * @brief Keeps the weights also as integers: each weight (in hours) is rounded to the nearest multiple
+ * of 1/unidadesPorHora. With the default of tenths of a second, a route with a thousand edges is off by
+ * at most a minute and a half, and a 32 bit distance only overflows after 119304 hours.
+ */
+template<class T>
+void FrozenGraph<T>::quantize(unsigned int unidadesPorHora) {
+	unitsPerHour = unidadesPorHora;
+	quantWeights.resize(weights.size());
+	for (unsigned int e = 0; e < weights.size(); e++)
+		quantWeights[e] = (unsigned int) ((double) weights[e] * unidadesPorHora
+				+ 0.5);
+}
+
+/**
+ * @brief Dijkstra over the integer weights (quantize() must have been called), with a radix heap:
+ * every comparison is between 32 bit integers. A vertex improved again is inserted again, and its
+ * older entries are skipped when they come out of the heap.
+ * @return the distance from s to t in units of 1/getUnitsPerHour() hours (UINT_MAX if unreachable or
+ * t is NO_VERTEX)
+ */
+template<class T>
+unsigned int FrozenGraph<T>::radixDijkstra(unsigned int s, unsigned int t,
+		SearchWorkspace<unsigned int> &ws, RadixHeap &q) const {
+	ws.beginQuery(infos.size());
+	q.clear();
+	ws.setDist(s, 0, NO_VERTEX);
+	q.insert(s, 0);
+
+	while (!q.empty()) {
+		unsigned int dv;
+		unsigned int v = q.extractMin(dv);
+		if (dv != ws.getDist(v))
+			continue;
+		ws.countSettled();
+		if (v == t)
+			break;
+
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+			unsigned int w = targets[e];
+			unsigned int nova = dv + quantWeights[e];
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v);
+				q.insert(w, nova);
+			}
+		}
+	}
+	return t == NO_VERTEX ? ws.infinity() : ws.getDist(t);
+}
+
+/**
+ * @brief Translates the search tree left by a search into the path from s to t.
+ * @return the path, or an empty vector if t was not reached
+ */
+template<class T>
+template<class W>
+vector<T> FrozenGraph<T>::getPath(unsigned int s, unsigned int t,
+		const SearchWorkspace<W> &ws) const {
+	list<T> buffer;
+	vector<T> res;
+	unsigned int v = t;
+	while (v != s) {
+		if (v == NO_VERTEX)
+			return res;
+		buffer.push_front(infos[v]);
+		v = ws.getPath(v);
+	}
+	buffer.push_front(infos[s]);
+
+	res.assign(buffer.begin(), buffer.end());
+	return res;
+}
+
+/**
+ * @brief Bidirectional A*: a forward search from s and a backward search (over the reverse adjacency)
+ * from t, always advancing the one with the smaller key.
+ * Both use the average potential pf(v) = (toTarget(v) - fromSource(v)) / 2 (and pb = -pf), which is
+ * consistent for both directions, so the search can stop as soon as the two smallest keys add up to
+ * the best path found. With zero heuristics this is bidirectional Dijkstra.
+ * @param toTarget lower bound of the distance from a vertex to t
+ * @param fromSource lower bound of the distance from s to a vertex
+ * @param meio the vertex where the best forward and backward paths meet (NO_VERTEX if none)
+ * @return the distance from s to t (infinity if t is unreachable)
+ */
+template<class T>
+template<class HF, class HB>
+float FrozenGraph<T>::bidirectionalAStar(unsigned int s, unsigned int t,
+		const HF &toTarget, const HB &fromSource,
+		SearchWorkspace<float> &forward, SearchWorkspace<float> &backward,
+		unsigned int &meio) const {
+	forward.beginQuery(infos.size());
+	backward.beginQuery(infos.size());
+	IndexedHeap<float> &fq = forward.getQueue();
+	IndexedHeap<float> &bq = backward.getQueue();
+	forward.setDist(s, 0, NO_VERTEX);
+	fq.insert(s, (toTarget(s) - fromSource(s)) / 2);
+	backward.setDist(t, 0, NO_VERTEX);
+	bq.insert(t, (fromSource(t) - toTarget(t)) / 2);
+
+	float melhor = SearchWorkspace<float>::infinity();
+	meio = NO_VERTEX;
+	if (s == t) {
+		meio = s;
+		melhor = 0;
+	}
+
+	while (!fq.empty() && !bq.empty() && fq.minKey() + bq.minKey() < melhor) {
+		if (fq.minKey() <= bq.minKey()) {
+			unsigned int v = fq.extractMin();
+			forward.countSettled();
+			float dv = forward.getDist(v);
+			for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++) {
+				unsigned int w = targets[e];
+				float nova = dv + weights[e];
+				if (nova < forward.getDist(w)) {
+					forward.setDist(w, nova, v);
+					fq.insertOrDecrease(w,
+							nova + (toTarget(w) - fromSource(w)) / 2);
+					if (backward.reached(w)
+							&& nova + backward.getDist(w) < melhor) {
+						melhor = nova + backward.getDist(w);
+						meio = w;
+					}
+				}
+			}
+		} else {
+			unsigned int v = bq.extractMin();
+			backward.countSettled();
+			float dv = backward.getDist(v);
+			for (unsigned int e = revOffsets[v]; e < revOffsets[v + 1]; e++) {
+				unsigned int u = revSources[e];
+				float nova = dv + revWeights[e];
+				if (nova < backward.getDist(u)) {
+					backward.setDist(u, nova, v);
+					bq.insertOrDecrease(u,
+							nova + (fromSource(u) - toTarget(u)) / 2);
+					if (forward.reached(u)
+							&& nova + forward.getDist(u) < melhor) {
+						melhor = nova + forward.getDist(u);
+						meio = u;
+					}
+				}
+			}
+		}
+	}
+	return melhor;
+}
+
+template<class T>
+float FrozenGraph<T>::bidirectionalDijkstra(unsigned int s, unsigned int t,
+		SearchWorkspace<float> &forward, SearchWorkspace<float> &backward,
+		unsigned int &meio) const {
+	return bidirectionalAStar(s, t, noHeuristic(), noHeuristic(), forward,
+			backward, meio);
+}
+
+/**
+ * @brief Joins the two search trees left by a bidirectional search: s .. meio from the forward tree
+ * and meio .. t from the backward one.
+ * @return the path, or an empty vector if the searches did not meet
+ */
+template<class T>
+vector<T> FrozenGraph<T>::getPath(unsigned int meio,
+		const SearchWorkspace<float> &forward,
+		const SearchWorkspace<float> &backward) const {
+	list<T> buffer;
+	if (meio == NO_VERTEX)
+		return vector<T>();
+	for (unsigned int v = meio; v != NO_VERTEX; v = forward.getPath(v))
+		buffer.push_front(infos[v]);
+	for (unsigned int v = backward.getPath(meio); v != NO_VERTEX; v =
+			backward.getPath(v))
+		buffer.push_back(infos[v]);
+	return vector<T>(buffer.begin(), buffer.end());
+}
+
+template<class T>
+vector<T> FrozenGraph<T>::getDijkstraPath(const T &origin, const T &dest,
+		SearchWorkspace<float> &ws) const {
+	unsigned int s = getIndex(origin), t = getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return vector<T>();
+	dijkstra(s, t, ws);
+	return getPath(s, t, ws);
+}
+
+template<class T>
+vector<T> FrozenGraph<T>::getRadixDijkstraPath(const T &origin, const T &dest,
+		SearchWorkspace<unsigned int> &ws, RadixHeap &q) const {
+	unsigned int s = getIndex(origin), t = getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return vector<T>();
+	radixDijkstra(s, t, ws, q);
+	return getPath(s, t, ws);
+}
+
+template<class T>
+template<class H>
+vector<T> FrozenGraph<T>::getA_starPath(const T &origin, const T &dest,
+		const H &heuristic, SearchWorkspace<float> &ws) const {
+	unsigned int s = getIndex(origin), t = getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return vector<T>();
+	aStar(s, t, heuristic, ws);
+	return getPath(s, t, ws);
+}
+
+template<class T>
+vector<T> FrozenGraph<T>::getBidirectionalDijkstraPath(const T &origin,
+		const T &dest, SearchWorkspace<float> &forward,
+		SearchWorkspace<float> &backward) const {
+	unsigned int s = getIndex(origin), t = getIndex(dest), meio;
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return vector<T>();
+	bidirectionalDijkstra(s, t, forward, backward, meio);
+	return getPath(meio, forward, backward);
+}
+
+template<class T>
+template<class HF, class HB>
+vector<T> FrozenGraph<T>::getBidirectionalA_starPath(const T &origin,
+		const T &dest, const HF &toTarget, const HB &fromSource,
+		SearchWorkspace<float> &forward,
+		SearchWorkspace<float> &backward) const {
+	unsigned int s = getIndex(origin), t = getIndex(dest), meio;
+	if (s == NO_VERTEX || t == NO_VERTEX)
+		return vector<T>();
+	bidirectionalAStar(s, t, toTarget, fromSource, forward, backward, meio);
+	return getPath(meio, forward, backward);
+}
+
+#endif /* SRC_FROZENGRAPH_H_ */
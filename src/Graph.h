@@ -11,11 +11,22 @@
 #include <cmath>
 #include <limits.h>
 #include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <new>
+#include "IndexedHeap.h"
+#include "SearchWorkspace.h"
+#include "FloydWarshall.h"
+#include "Arena.h"
+#include "ArrayView.h"
 
 using namespace std;
 
-template<class T> class Edge;
-template<class T> class Graph;
+template<class T, class W = long double> class Vertex;
+template<class T, class W = long double> class Edge;
+template<class T, class W = long double> class Graph;
+template<class T> class FrozenGraph;
+template<class T> class GraphBuilder;
 
 const int NOT_VISITED = 0;
 const int BEING_VISITED = 1;
@@ -28,66 +39,47 @@ const unsigned int INT_INFINITY = 10000000;
  * Class Vertex
  * ================================================================================================
  */
-template<class T>
+template<class T, class W>
 class Vertex {
-	T info;
-	vector<Edge<T> > adj;
-	bool visited;
-	bool processing;
+public:
+	typedef vector<Edge<T, W>, ArenaAllocator<Edge<T, W> > > EdgeList;
+private:
+	//campos lidos pelas pesquisas primeiro, a informacao (fria) no fim
+	EdgeList adj;
+	unsigned int index; //posicao no vertexSet, indice nos SearchWorkspace e filas de prioridade
 	int indegree;
-	long double dist;
-	long double dist_DESTINY = 0.0; //distancia so usada antes de carregar a*
+	T info;
 public:
 
-	Vertex(T in);
-	friend class Graph<T> ;
-
-	void setDestiny(long double dest) {
-		this->dist_DESTINY = dest;
-	}
-	;
-	long double getDestinyDistance() {
-		return dist_DESTINY;
-	}
-	;
+	Vertex(T in, Arena *arena = NULL);
+	friend class Graph<T, W> ;
+	friend class GraphBuilder<T> ;
 
-	void addEdge(Vertex<T> *dest, long double w);
-	void addEdge(Vertex<T> *dest, long double w, unsigned long long id);
+	void addEdge(Vertex<T, W> *dest, W w);
+	void addEdge(Vertex<T, W> *dest, W w, unsigned long long id);
 	unsigned long long getIdEdge(const T& dest);
-	bool removeEdgeTo(Vertex<T> *d);
+	bool removeEdgeTo(Vertex<T, W> *d);
 
-	T getInfo() const;
+	const T &getInfo() const;
 	void setInfo(T info);
 
-	long double getDist() const;
+	unsigned int getIndex() const {
+		return index;
+	}
 	int getIndegree() const;
-	vector<Edge<T>> getEdges() {
+	/**
+	 * @return the outgoing edges, without copying them (see ArrayView)
+	 */
+	ArrayView<Edge<T, W> > getEdges() const {
 		return adj;
 	}
-	;
-	Vertex* path;
-};
-
-template<class T> //for Dijkstra
-struct vertex_greater_than {
-	bool operator()(Vertex<T> * a, Vertex<T> * b) const {
-		return a->getDist() > b->getDist();
-	}
 };
 
-template<class T>  //for A*
-struct vertex_greater_than_A {
-	bool operator()(Vertex<T> * a, Vertex<T> * b) const {
-		return (a->getDist() + a->getDestinyDistance())
-				> (b->getDist() + b->getDestinyDistance());
-	}
-};
-
-template<class T>
-bool Vertex<T>::removeEdgeTo(Vertex<T> *d) {
+template<class T, class W>
+bool Vertex<T, W>::removeEdgeTo(Vertex<T, W> *d) {
 	d->indegree--; //adicionado do exercicio 5
-	typename vector<Edge<T> >::iterator it = adj.begin();
-	typename vector<Edge<T> >::iterator ite = adj.end();
+	typename EdgeList::iterator it = adj.begin();
+	typename EdgeList::iterator ite = adj.end();
 	while (it != ite) {
 		if (it->dest == d) {
 			adj.erase(it);
@@ -99,41 +91,35 @@ bool Vertex<T>::removeEdgeTo(Vertex<T> *d) {
 }
 
 //atualizado pelo exerccio 5
-template<class T>
-Vertex<T>::Vertex(T in) :
-		info(in), visited(false), processing(false), indegree(0), dist(0) {
-	path = NULL;
+template<class T, class W>
+Vertex<T, W>::Vertex(T in, Arena *arena) :
+		adj(ArenaAllocator<Edge<T, W> >(arena)), index(0), indegree(0), info(in) {
 }
 
-template<class T>
-void Vertex<T>::addEdge(Vertex<T> *dest, long double w) {
-	Edge<T> edgeD(dest, w);
+template<class T, class W>
+void Vertex<T, W>::addEdge(Vertex<T, W> *dest, W w) {
+	Edge<T, W> edgeD(dest, w);
 	adj.push_back(edgeD);
 }
 
-template<class T>
-void Vertex<T>::addEdge(Vertex<T> *dest, long double w, unsigned long long id) {
-	Edge<T> edgeD(dest, w, id);
+template<class T, class W>
+void Vertex<T, W>::addEdge(Vertex<T, W> *dest, W w, unsigned long long id) {
+	Edge<T, W> edgeD(dest, w, id);
 	adj.push_back(edgeD);
 }
 
-template<class T>
-T Vertex<T>::getInfo() const {
+template<class T, class W>
+const T &Vertex<T, W>::getInfo() const {
 	return this->info;
 }
 
-template<class T>
-long double Vertex<T>::getDist() const {
-	return this->dist;
-}
-
-template<class T>
-void Vertex<T>::setInfo(T info) {
+template<class T, class W>
+void Vertex<T, W>::setInfo(T info) {
 	this->info = info;
 }
 
-template<class T>
-unsigned long long Vertex<T>::getIdEdge(const T& dest) {
+template<class T, class W>
+unsigned long long Vertex<T, W>::getIdEdge(const T& dest) {
 	for (unsigned int i = 0; i < adj.size(); i++) {
 		if (adj[i].dest->getInfo() == dest)
 			return adj[i].id;
@@ -142,8 +128,8 @@ unsigned long long Vertex<T>::getIdEdge(const T& dest) {
 	return -1;
 }
 
-template<class T>
-int Vertex<T>::getIndegree() const {
+template<class T, class W>
+int Vertex<T, W>::getIndegree() const {
 	return this->indegree;
 }
 
@@ -151,31 +137,34 @@ int Vertex<T>::getIndegree() const {
  * Class Edge
  * ================================================================================================
  */
-template<class T>
+template<class T, class W>
 class Edge {
-
-	Vertex<T> * dest;
-	string name;
-	long double weight = 0.0;
+	W weight = 0;
+	unsigned int destIndex; //indice do destino, para as pesquisas nao lerem o vertice de destino
+	Vertex<T, W> * dest;
 public:
 	unsigned long long id;
-	Edge(Vertex<T> *d, long double w);
-	Edge(Vertex<T> *d, long double w, unsigned long long id);
-	friend class Graph<T> ;
-	friend class Vertex<T> ;
+	Edge(Vertex<T, W> *d, W w);
+	Edge(Vertex<T, W> *d, W w, unsigned long long id);
+	W getWeight() const {
+		return weight;
+	}
+	Vertex<T, W> *getDest() const {
+		return dest;
+	}
+	friend class Graph<T, W> ;
+	friend class Vertex<T, W> ;
 };
 
-template<class T>
-Edge<T>::Edge(Vertex<T> *d, long double w) :
-		dest(d), weight(w) {
-	this->name = "unnamed";
+template<class T, class W>
+Edge<T, W>::Edge(Vertex<T, W> *d, W w) :
+		weight(w), destIndex(d->getIndex()), dest(d) {
 	this->id = 0;
 }
 
-template<class T>
-Edge<T>::Edge(Vertex<T> *d, long double w, unsigned long long id) :
-		dest(d), weight(w) {
-	this->name = "unnamed";
+template<class T, class W>
+Edge<T, W>::Edge(Vertex<T, W> *d, W w, unsigned long long id) :
+		weight(w), destIndex(d->getIndex()), dest(d) {
 	this->id = id;
 }
 
@@ -183,23 +172,46 @@ Edge<T>::Edge(Vertex<T> *d, long double w, unsigned long long id) :
  * Class Graph
  * ================================================================================================
  */
-template<class T>
+/**
+ * Weights are given in hours and kept as W (see WeightTraits): long double by default, or float,
+ * double or unsigned int fixed point. The searches are templates on the heuristic and on the queue of
+ * their SearchWorkspace, so each combination compiles to its own search, with no indirect calls.
+ */
+template<class T, class W>
 class Graph {
-	vector<Vertex<T> *> vertexSet;
-	void dfs(Vertex<T> *v, vector<T> &res) const;
+	Arena arena; //vertices e listas de arestas, libertados de uma vez no destrutor
+	vector<Vertex<T, W> *> vertexSet;
+	unordered_map<T, Vertex<T, W> *> vertexIndex; //info -> vertice, requer std::hash<T>
+	unsigned int numEdges = 0;
+	unsigned int versao = 0; //incrementada a cada alteracao, invalida a cache do Floyd-Warshall
+	void dfs(Vertex<T, W> *v, vector<T> &res, vector<bool> &visited) const;
 
 	//exercicio 5
 	int numCycles;
-	void dfsVisit(Vertex<T> *v);
+	void dfsVisit(Vertex<T, W> *v, vector<bool> &visited,
+			vector<bool> &processing);
 	void dfsVisit();
-	void getPathTo(Vertex<T> *origin, list<T> &res);
-	int edgeCost(int i, int j);
+	void getPathTo(Vertex<T, W> *origin, list<T> &res);
 
 	//exercicio 6
-	vector<vector<long double>> distancias;
-	vector<vector<int>> precedentes;
+	//matrizes n x n contiguas (linhas com floydStride elementos), validas para a versao floydVersao
+	vector<float> distancias;
+	vector<int> arestasFloyd; //numero de arestas de cada caminho, desempata distancias iguais
+	vector<unsigned int> precedentes;
+	unsigned int floydStride = 0;
+	unsigned int floydVersao = UINT_MAX;
+
+	//os vertices pertencem a arena deste grafo
+	Graph(const Graph &);
+	Graph &operator=(const Graph &);
+
+	friend class GraphBuilder<T> ;
 
 public:
+	Graph() {
+	}
+	~Graph();
+	void reserve(unsigned int numVertices);
 	bool addVertex(const T &in);
 	bool addEdge(const T &sourc, const T &dest, long double w);
 	bool addEdge(const T &sourc, const T &dest, long double w,
@@ -207,217 +219,269 @@ public:
 	bool removeVertex(const T &in);
 	bool removeEdge(const T &sourc, const T &dest);
 	vector<T> dfs() const;
-	vector<T> bfs(Vertex<T> *v) const;
-	int maxNewChildren(Vertex<T> *v, T &inf) const;
-	vector<Vertex<T> *> getVertexSet() const;
+	vector<T> bfs(Vertex<T, W> *v) const;
+	int maxNewChildren(Vertex<T, W> *v, T &inf) const;
+	ArrayView<Vertex<T, W> *> getVertexSet() const;
 	int getNumVertex() const;
+	unsigned int getNumEdges() const;
+	unsigned int getVersion() const;
+	size_t getMemoryBytes() const;
+	const Arena &getArena() const {
+		return arena;
+	}
 
 	//exercicio 5
-	Vertex<T>* getVertex(const T &v) const;
+	Vertex<T, W>* getVertex(const T &v) const;
 	void resetIndegrees();
-	vector<Vertex<T>*> getSources() const;
+	vector<Vertex<T, W>*> getSources() const;
 	int getNumCycles();
 	vector<T> topologicalOrder();
-	vector<T> getPath(const T &origin, const T &dest);
-	void unweightedShortestPath(const T &v);
+	template<class Q>
+	vector<T> getPath(const T &origin, const T &dest,
+			const SearchWorkspace<W, Q> &ws) const;
+	void unweightedShortestPath(const T &v, SearchWorkspace<W> &ws) const;
 	bool isDAG();
 	//exercicio 6
-	void bellmanFordShortestPath(const T &s);
-	void dijkstraShortestPath_all(const T &s);
+	void bellmanFordShortestPath(const T &s, SearchWorkspace<W> &ws) const;
+	void dijkstraShortestPath_all(const T &s, SearchWorkspace<W> &ws) const;
 	void floydWarshallShortestPath();
 	vector<T> getfloydWarshallPath(const T &origin, const T &dest);
 
 	//testing
-
-	void A_star_all(const T &origin, const T &dest);
-	void A_star(const T &origin, const T &dest);
-	vector<T> getA_starPath(const T &origin, const T &dest);
-	void dijkstraShortestPath(const T &s, const T& dest);
-	vector<T> getDijkstraPath(const T& origin, const T& dest);
-	vector<T> getDijkstraPathAll(const T& origin, const T& dest);
+	//as pesquisas so leem o grafo, o estado fica no SearchWorkspace (um por thread)
+	template<class H, class Q>
+	void A_star_all(const T &origin, const T &dest, const H &heuristic,
+			SearchWorkspace<W, Q> &ws) const;
+	template<class H, class Q>
+	void A_star(const T &origin, const T &dest, const H &heuristic,
+			SearchWorkspace<W, Q> &ws) const;
+	template<class H, class Q>
+	vector<T> getA_starPath(const T &origin, const T &dest, const H &heuristic,
+			SearchWorkspace<W, Q> &ws) const;
+	template<class Q>
+	void dijkstraShortestPath(const T &s, const T& dest,
+			SearchWorkspace<W, Q> &ws) const;
+	void dijkstraShortestPathMakeHeap(const T &s, const T& dest,
+			SearchWorkspace<W> &ws) const;
+	template<class Q>
+	vector<T> getDijkstraPath(const T& origin, const T& dest,
+			SearchWorkspace<W, Q> &ws) const;
+	vector<T> getDijkstraPathMakeHeap(const T& origin, const T& dest,
+			SearchWorkspace<W> &ws) const;
+	vector<T> getDijkstraPathAll(const T& origin, const T& dest,
+			SearchWorkspace<W> &ws) const;
+
+	//snapshot imutavel para as pesquisas (FrozenGraph.h)
+	FrozenGraph<T> freeze() const;
+	template<class W2>
+	void copyTo(Graph<T, W2> &res) const;
 };
 
-template<class T>
-int Graph<T>::getNumVertex() const {
+/**
+ * @brief Destroys the vertices (and their information) and gives the arena back to the system in bulk.
+ */
+template<class T, class W>
+Graph<T, W>::~Graph() {
+	for (unsigned int i = 0; i < vertexSet.size(); i++)
+		vertexSet[i]->~Vertex<T, W>();
+	arena.release();
+}
+
+template<class T, class W>
+int Graph<T, W>::getNumVertex() const {
 	return vertexSet.size();
 }
-template<class T>
-vector<Vertex<T> *> Graph<T>::getVertexSet() const {
+template<class T, class W>
+unsigned int Graph<T, W>::getNumEdges() const {
+	return numEdges;
+}
+
+/**
+ * @return a counter incremented by every change to the vertices or edges of the graph
+ */
+template<class T, class W>
+unsigned int Graph<T, W>::getVersion() const {
+	return versao;
+}
+
+/**
+ * @return the bytes taken by the vertices, the edges and the index by information (not counting the
+ * memory that T itself allocates, such as strings)
+ */
+template<class T, class W>
+size_t Graph<T, W>::getMemoryBytes() const {
+	size_t res = vertexSet.capacity() * sizeof(Vertex<T, W> *);
+	for (unsigned int i = 0; i < vertexSet.size(); i++)
+		res += sizeof(Vertex<T, W>) + vertexSet[i]->adj.capacity() * sizeof(Edge<T, W>);
+	//unordered_map: um no por elemento (o par e o ponteiro para o seguinte) e a tabela de buckets
+	res += vertexIndex.size() * (sizeof(pair<const T, Vertex<T, W> *>) + sizeof(void *))
+			+ vertexIndex.bucket_count() * sizeof(void *);
+	return res;
+}
+
+/**
+ * @return the vertices, by index, without copying them (see ArrayView)
+ */
+template<class T, class W>
+ArrayView<Vertex<T, W> *> Graph<T, W>::getVertexSet() const {
 	return vertexSet;
 }
 
-template<class T>
-int Graph<T>::getNumCycles() {
+template<class T, class W>
+int Graph<T, W>::getNumCycles() {
 	numCycles = 0;
 	dfsVisit();
 	return this->numCycles;
 }
 
-template<class T>
-bool Graph<T>::isDAG() {
+template<class T, class W>
+bool Graph<T, W>::isDAG() {
 	return (getNumCycles() == 0);
 }
 
-template<class T>
-bool Graph<T>::addVertex(const T &in) {
-	typename vector<Vertex<T>*>::iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::iterator ite = vertexSet.end();
-	for (; it != ite; it++)
-		if ((*it)->info == in)
-			return false;
-	Vertex<T> *v1 = new Vertex<T>(in);
+/**
+ * @brief Makes room for numVertices vertices, so loading a whole map doesn't rehash the index.
+ */
+template<class T, class W>
+void Graph<T, W>::reserve(unsigned int numVertices) {
+	vertexSet.reserve(numVertices);
+	vertexIndex.reserve(numVertices);
+}
+
+template<class T, class W>
+bool Graph<T, W>::addVertex(const T &in) {
+	if (vertexIndex.find(in) != vertexIndex.end())
+		return false;
+	Vertex<T, W> *v1 = new (arena.allocate(sizeof(Vertex<T, W>))) Vertex<T, W>(in, &arena);
+	v1->index = vertexSet.size();
 	vertexSet.push_back(v1);
+	vertexIndex[in] = v1;
+	versao++;
 	return true;
 }
 
-template<class T>
-bool Graph<T>::removeVertex(const T &in) {
-	typename vector<Vertex<T>*>::iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::iterator ite = vertexSet.end();
-	for (; it != ite; it++) {
-		if ((*it)->info == in) {
-			Vertex<T> * v = *it;
-			vertexSet.erase(it);
-			typename vector<Vertex<T>*>::iterator it1 = vertexSet.begin();
-			typename vector<Vertex<T>*>::iterator it1e = vertexSet.end();
-			for (; it1 != it1e; it1++) {
-				(*it1)->removeEdgeTo(v);
-			}
+template<class T, class W>
+bool Graph<T, W>::removeVertex(const T &in) {
+	typename unordered_map<T, Vertex<T, W> *>::iterator found = vertexIndex.find(in);
+	if (found == vertexIndex.end())
+		return false;
+	Vertex<T, W> * v = found->second;
+	vertexIndex.erase(found);
+
+	vertexSet.erase(vertexSet.begin() + v->index);
+	for (unsigned int i = v->index; i < vertexSet.size(); i++)
+		vertexSet[i]->index = i;
+
+	typename vector<Vertex<T, W>*>::iterator it1 = vertexSet.begin();
+	typename vector<Vertex<T, W>*>::iterator it1e = vertexSet.end();
+	for (; it1 != it1e; it1++) {
+		if ((*it1)->removeEdgeTo(v))
+			numEdges--;
+		//os vertices depois de v desceram uma posicao
+		for (unsigned int j = 0; j < (*it1)->adj.size(); j++)
+			(*it1)->adj[j].destIndex = (*it1)->adj[j].dest->index;
+	}
 
-			typename vector<Edge<T> >::iterator itAdj = v->adj.begin();
-			typename vector<Edge<T> >::iterator itAdje = v->adj.end();
-			for (; itAdj != itAdje; itAdj++) {
-				itAdj->dest->indegree--;
-			}
-			delete v;
-			return true;
-		}
+	typename Vertex<T, W>::EdgeList::iterator itAdj = v->adj.begin();
+	typename Vertex<T, W>::EdgeList::iterator itAdje = v->adj.end();
+	for (; itAdj != itAdje; itAdj++) {
+		itAdj->dest->indegree--;
 	}
-	return false;
+	numEdges -= v->adj.size();
+	v->~Vertex<T, W>();
+	arena.deallocate(v, sizeof(Vertex<T, W>));
+	versao++;
+	return true;
 }
 
-template<class T>
-bool Graph<T>::addEdge(const T &sourc, const T &dest, long double w) {
-	typename vector<Vertex<T>*>::iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::iterator ite = vertexSet.end();
-	int found = 0;
-	Vertex<T> *vS, *vD;
-	vS = NULL; vD = NULL; //TODO CUIDADO COM ISTO
-	while (found != 2 && it != ite) {
-		if ((*it)->info == sourc) {
-			vS = *it;
-			found++;
-		}
-		if ((*it)->info == dest) {
-			vD = *it;
-			found++;
-		}
-		it++;
-	}
-	if (found != 2)
+template<class T, class W>
+bool Graph<T, W>::addEdge(const T &sourc, const T &dest, long double w) {
+	Vertex<T, W> *vS = getVertex(sourc);
+	Vertex<T, W> *vD = getVertex(dest);
+	if (vS == NULL || vD == NULL)
 		return false;
 
 	vD->indegree++;
-	vS->addEdge(vD, w);
+	vS->addEdge(vD, WeightTraits<W>::fromHours(w));
+	numEdges++;
+	versao++;
 
 	return true;
 }
 
-template<class T>
-bool Graph<T>::addEdge(const T &sourc, const T &dest, long double w,
+template<class T, class W>
+bool Graph<T, W>::addEdge(const T &sourc, const T &dest, long double w,
 		unsigned long long id) {
-	typename vector<Vertex<T>*>::iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::iterator ite = vertexSet.end();
-	int found = 0;
-	Vertex<T> *vS, *vD;
-	vS = NULL; vD = NULL; //TODO CUIDADO COM ISTO2
-	while (found != 2 && it != ite) {
-		if ((*it)->info == sourc) {
-			vS = *it;
-			found++;
-		}
-		if ((*it)->info == dest) {
-			vD = *it;
-			found++;
-		}
-		it++;
-	}
-	if (found != 2)
+	Vertex<T, W> *vS = getVertex(sourc);
+	Vertex<T, W> *vD = getVertex(dest);
+	if (vS == NULL || vD == NULL)
 		return false;
+
 	vD->indegree++;
-	vS->addEdge(vD, w, id);
+	vS->addEdge(vD, WeightTraits<W>::fromHours(w), id);
+	numEdges++;
+	versao++;
 
 	return true;
 }
 
-template<class T>
-bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
-	typename vector<Vertex<T>*>::iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::iterator ite = vertexSet.end();
-	int found = 0;
-	Vertex<T> *vS, *vD;
-	vS = NULL; vD = NULL; //TODO CUIDADO COM ISTO3
-	while (found != 2 && it != ite) {
-		if ((*it)->info == sourc) {
-			vS = *it;
-			found++;
-		}
-		if ((*it)->info == dest) {
-			vD = *it;
-			found++;
-		}
-		it++;
-	}
-	if (found != 2)
+template<class T, class W>
+bool Graph<T, W>::removeEdge(const T &sourc, const T &dest) {
+	Vertex<T, W> *vS = getVertex(sourc);
+	Vertex<T, W> *vD = getVertex(dest);
+	if (vS == NULL || vD == NULL)
 		return false;
 
 	vD->indegree--;
 
-	return vS->removeEdgeTo(vD);
+	if (!vS->removeEdgeTo(vD))
+		return false;
+	numEdges--;
+	versao++;
+	return true;
 }
 
-template<class T>
-vector<T> Graph<T>::dfs() const {
-	typename vector<Vertex<T>*>::const_iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::const_iterator ite = vertexSet.end();
-	for (; it != ite; it++)
-		(*it)->visited = false;
+template<class T, class W>
+vector<T> Graph<T, W>::dfs() const {
+	vector<bool> visited(vertexSet.size(), false);
 	vector<T> res;
-	it = vertexSet.begin();
+	typename vector<Vertex<T, W>*>::const_iterator it = vertexSet.begin();
+	typename vector<Vertex<T, W>*>::const_iterator ite = vertexSet.end();
 	for (; it != ite; it++)
-		if ((*it)->visited == false)
-			dfs(*it, res);
+		if (visited[(*it)->index] == false)
+			dfs(*it, res, visited);
 	return res;
 }
 
-template<class T>
-void Graph<T>::dfs(Vertex<T> *v, vector<T> &res) const {
-	v->visited = true;
+template<class T, class W>
+void Graph<T, W>::dfs(Vertex<T, W> *v, vector<T> &res, vector<bool> &visited) const {
+	visited[v->index] = true;
 	res.push_back(v->info);
-	typename vector<Edge<T> >::iterator it = (v->adj).begin();
-	typename vector<Edge<T> >::iterator ite = (v->adj).end();
+	typename Vertex<T, W>::EdgeList::iterator it = (v->adj).begin();
+	typename Vertex<T, W>::EdgeList::iterator ite = (v->adj).end();
 	for (; it != ite; it++)
-		if (it->dest->visited == false) {
-			dfs(it->dest, res);
+		if (visited[it->dest->index] == false) {
+			dfs(it->dest, res, visited);
 		}
 }
 
-template<class T>
-vector<T> Graph<T>::bfs(Vertex<T> *v) const {
+template<class T, class W>
+vector<T> Graph<T, W>::bfs(Vertex<T, W> *v) const {
 	vector<T> res;
-	queue<Vertex<T> *> q;
+	vector<bool> visited(vertexSet.size(), false);
+	queue<Vertex<T, W> *> q;
 	q.push(v);
-	v->visited = true;
+	visited[v->index] = true;
 	while (!q.empty()) {
-		Vertex<T> *v1 = q.front();
+		Vertex<T, W> *v1 = q.front();
 		q.pop();
 		res.push_back(v1->info);
-		typename vector<Edge<T> >::iterator it = v1->adj.begin();
-		typename vector<Edge<T> >::iterator ite = v1->adj.end();
+		typename Vertex<T, W>::EdgeList::iterator it = v1->adj.begin();
+		typename Vertex<T, W>::EdgeList::iterator ite = v1->adj.end();
 		for (; it != ite; it++) {
-			Vertex<T> *d = it->dest;
-			if (d->visited == false) {
-				d->visited = true;
+			Vertex<T, W> *d = it->dest;
+			if (visited[d->index] == false) {
+				visited[d->index] = true;
 				q.push(d);
 			}
 		}
@@ -425,30 +489,31 @@ vector<T> Graph<T>::bfs(Vertex<T> *v) const {
 	return res;
 }
 
-template<class T>
-int Graph<T>::maxNewChildren(Vertex<T> *v, T &inf) const {
+template<class T, class W>
+int Graph<T, W>::maxNewChildren(Vertex<T, W> *v, T &inf) const {
 	vector<T> res;
-	queue<Vertex<T> *> q;
+	vector<bool> visited(vertexSet.size(), false);
+	queue<Vertex<T, W> *> q;
 	queue<int> level;
 	int maxChildren = 0;
 	inf = v->info;
 	q.push(v);
 	level.push(0);
-	v->visited = true;
+	visited[v->index] = true;
 	while (!q.empty()) {
-		Vertex<T> *v1 = q.front();
+		Vertex<T, W> *v1 = q.front();
 		q.pop();
 		res.push_back(v1->info);
 		int l = level.front();
 		level.pop();
 		l++;
 		int nChildren = 0;
-		typename vector<Edge<T> >::iterator it = v1->adj.begin();
-		typename vector<Edge<T> >::iterator ite = v1->adj.end();
+		typename Vertex<T, W>::EdgeList::iterator it = v1->adj.begin();
+		typename Vertex<T, W>::EdgeList::iterator ite = v1->adj.end();
 		for (; it != ite; it++) {
-			Vertex<T> *d = it->dest;
-			if (d->visited == false) {
-				d->visited = true;
+			Vertex<T, W> *d = it->dest;
+			if (visited[d->index] == false) {
+				visited[d->index] = true;
 				q.push(d);
 				level.push(l);
 				nChildren++;
@@ -462,16 +527,16 @@ int Graph<T>::maxNewChildren(Vertex<T> *v, T &inf) const {
 	return maxChildren;
 }
 
-template<class T>
-Vertex<T>* Graph<T>::getVertex(const T &v) const {
-	for (unsigned int i = 0; i < vertexSet.size(); i++)
-		if (vertexSet[i]->info == v)
-			return vertexSet[i];
-	return NULL;
+template<class T, class W>
+Vertex<T, W>* Graph<T, W>::getVertex(const T &v) const {
+	typename unordered_map<T, Vertex<T, W> *>::const_iterator it = vertexIndex.find(v);
+	if (it == vertexIndex.end())
+		return NULL;
+	return it->second;
 }
 
-template<class T>
-void Graph<T>::resetIndegrees() {
+template<class T, class W>
+void Graph<T, W>::resetIndegrees() {
 	//colocar todos os indegree em 0;
 	for (unsigned int i = 0; i < vertexSet.size(); i++)
 		vertexSet[i]->indegree = 0;
@@ -485,9 +550,9 @@ void Graph<T>::resetIndegrees() {
 	}
 }
 
-template<class T>
-vector<Vertex<T>*> Graph<T>::getSources() const {
-	vector<Vertex<T>*> buffer;
+template<class T, class W>
+vector<Vertex<T, W>*> Graph<T, W>::getSources() const {
+	vector<Vertex<T, W>*> buffer;
 	for (unsigned int i = 0; i < vertexSet.size(); i++) {
 		if (vertexSet[i]->indegree == 0)
 			buffer.push_back(vertexSet[i]);
@@ -495,36 +560,36 @@ vector<Vertex<T>*> Graph<T>::getSources() const {
 	return buffer;
 }
 
-template<class T>
-void Graph<T>::dfsVisit() {
-	typename vector<Vertex<T>*>::const_iterator it = vertexSet.begin();
-	typename vector<Vertex<T>*>::const_iterator ite = vertexSet.end();
-	for (; it != ite; it++)
-		(*it)->visited = false;
-	it = vertexSet.begin();
+template<class T, class W>
+void Graph<T, W>::dfsVisit() {
+	vector<bool> visited(vertexSet.size(), false);
+	vector<bool> processing(vertexSet.size(), false);
+	typename vector<Vertex<T, W>*>::const_iterator it = vertexSet.begin();
+	typename vector<Vertex<T, W>*>::const_iterator ite = vertexSet.end();
 	for (; it != ite; it++)
-		if ((*it)->visited == false)
-			dfsVisit(*it);
+		if (visited[(*it)->index] == false)
+			dfsVisit(*it, visited, processing);
 }
 
-template<class T>
-void Graph<T>::dfsVisit(Vertex<T> *v) {
-	v->processing = true;
-	v->visited = true;
-	typename vector<Edge<T> >::iterator it = (v->adj).begin();
-	typename vector<Edge<T> >::iterator ite = (v->adj).end();
+template<class T, class W>
+void Graph<T, W>::dfsVisit(Vertex<T, W> *v, vector<bool> &visited,
+		vector<bool> &processing) {
+	processing[v->index] = true;
+	visited[v->index] = true;
+	typename Vertex<T, W>::EdgeList::iterator it = (v->adj).begin();
+	typename Vertex<T, W>::EdgeList::iterator ite = (v->adj).end();
 	for (; it != ite; it++) {
-		if (it->dest->processing == true)
+		if (processing[it->dest->index] == true)
 			numCycles++;
-		if (it->dest->visited == false) {
-			dfsVisit(it->dest);
+		if (visited[it->dest->index] == false) {
+			dfsVisit(it->dest, visited, processing);
 		}
 	}
-	v->processing = false;
+	processing[v->index] = false;
 }
 
-template<class T>
-vector<T> Graph<T>::topologicalOrder() {
+template<class T, class W>
+vector<T> Graph<T, W>::topologicalOrder() {
 	//vector com o resultado da ordenacao
 	vector<T> res;
 
@@ -537,9 +602,9 @@ vector<T> Graph<T>::topologicalOrder() {
 	//garantir que os "indegree" estao inicializados corretamente
 	this->resetIndegrees();
 
-	queue<Vertex<T>*> q;
+	queue<Vertex<T, W>*> q;
 
-	vector<Vertex<T>*> sources = getSources();
+	vector<Vertex<T, W>*> sources = getSources();
 	while (!sources.empty()) {
 		q.push(sources.back());
 		sources.pop_back();
@@ -547,7 +612,7 @@ vector<T> Graph<T>::topologicalOrder() {
 
 	//processar fontes
 	while (!q.empty()) {
-		Vertex<T>* v = q.front();
+		Vertex<T, W>* v = q.front();
 		q.pop();
 
 		res.push_back(v->info);
@@ -571,20 +636,24 @@ vector<T> Graph<T>::topologicalOrder() {
 	return res;
 }
 
-template<class T>
-vector<T> Graph<T>::getPath(const T &origin, const T &dest) {
+template<class T, class W>
+template<class Q>
+vector<T> Graph<T, W>::getPath(const T &origin, const T &dest,
+		const SearchWorkspace<W, Q> &ws) const {
 
 	list<T> buffer;
-	Vertex<T>* v = getVertex(dest);
+	Vertex<T, W>* v = getVertex(dest);
 
 	//cout << v->info << " ";
 	buffer.push_front(v->info);
-	while (v->path != NULL && v->path->info != origin) {
-		v = v->path;
+	unsigned int anterior = ws.getPath(v->index);
+	while (anterior != ws.NO_VERTEX && vertexSet[anterior]->info != origin) {
+		v = vertexSet[anterior];
 		buffer.push_front(v->info);
+		anterior = ws.getPath(v->index);
 	}
-	if (v->path != NULL)
-		buffer.push_front(v->path->info);
+	if (anterior != ws.NO_VERTEX)
+		buffer.push_front(vertexSet[anterior]->info);
 
 	vector<T> res;
 	while (!buffer.empty()) {
@@ -594,54 +663,52 @@ vector<T> Graph<T>::getPath(const T &origin, const T &dest) {
 	return res;
 }
 
-template<class T>
-void Graph<T>::unweightedShortestPath(const T &s) {
-
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-	}
+template<class T, class W>
+void Graph<T, W>::unweightedShortestPath(const T &s,
+		SearchWorkspace<W> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-	Vertex<T>* v = getVertex(s);
-	v->dist = 0;
-	queue<Vertex<T>*> q;
+	Vertex<T, W>* v = getVertex(s);
+	if (v == NULL)
+		return;
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	queue<Vertex<T, W>*> q;
 	q.push(v);
 
 	while (!q.empty()) {
 		v = q.front();
 		q.pop();
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (w->dist == INT_INFINITY) {
-				w->dist = v->dist + 1;
-				w->path = v;
-				q.push(w);
+			unsigned int w = v->adj[i].destIndex;
+			if (!ws.reached(w)) {
+				ws.setDist(w, ws.getDist(v->index) + 1, v->index);
+				q.push(vertexSet[w]);
 			}
 		}
 	}
 }
 
-template<class T>
-void Graph<T>::bellmanFordShortestPath(const T& s) {
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-	}
+template<class T, class W>
+void Graph<T, W>::bellmanFordShortestPath(const T& s,
+		SearchWorkspace<W> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-	Vertex<T>* v = getVertex(s);
-	v->dist = 0;
-	queue<Vertex<T>*> q;
+	Vertex<T, W>* v = getVertex(s);
+	if (v == NULL)
+		return;
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	queue<Vertex<T, W>*> q;
 	q.push(v);
 
 	while (!q.empty()) {
 		v = q.front();
 		q.pop();
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (v->dist + v->adj[i].weight < w->dist) {
-				w->dist = v->dist + v->adj[i].weight;
-				w->path = v;
-				q.push(w);
+			unsigned int w = v->adj[i].destIndex;
+			W nova = ws.getDist(v->index) + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v->index);
+				q.push(vertexSet[w]);
 			}
 		}
 	}
@@ -651,207 +718,187 @@ void Graph<T>::bellmanFordShortestPath(const T& s) {
 
 }
 
-template<class T>
-void Graph<T>::dijkstraShortestPath_all(const T& s) {
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-		vertexSet[i]->processing = false; //estao na fila de espera
-	}
+template<class T, class W>
+void Graph<T, W>::dijkstraShortestPath_all(const T& s,
+		SearchWorkspace<W> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-	Vertex<T>* v = getVertex(s);
-	v->dist = 0;
-	vector<Vertex<T>*> q;
-	q.push_back(v);
-	make_heap(q.begin(), q.end(), vertex_greater_than<long double>()); //construir heap
+	Vertex<T, W>* v = getVertex(s);
+	if (v == NULL)
+		return;
 
-	while (!q.empty()) {
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	IndexedHeap<W> &q = ws.getQueue();
+	q.insert(v->index, 0);
 
-		pop_heap(q.begin(), q.end());
-		v = q[q.size() - 1];
-		q.pop_back();
+	while (!q.empty()) {
+		v = vertexSet[q.extractMin()];
+		W dv = ws.getDist(v->index);
 
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (v->dist + v->adj[i].weight < w->dist) {
-				w->dist = v->dist + v->adj[i].weight;
-				w->path = v;
-				if (!w->processing) {
-					q.push_back(w); //acrescenta
-					w->processing = true;
-				} // decrese key ou atualiza depois de introduzir w
-				make_heap(q.begin(), q.end(),
-						vertex_greater_than<long double>());
+			unsigned int w = v->adj[i].destIndex;
+			W nova = dv + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v->index);
+				q.insertOrDecrease(w, nova); //decrease key
 			}
 		}
 	}
 
 }
+template<class T, class W>
+template<class Q>
+void Graph<T, W>::dijkstraShortestPath(const T& s, const T& dest,
+		SearchWorkspace<W, Q> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-template<class T>
-void Graph<T>::dijkstraShortestPath(const T& s, const T& dest) {
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-		vertexSet[i]->processing = false; //estao na fila de espera
-	}
+	Vertex<T, W>* v = getVertex(s);
+	if (v == NULL)
+		return;
+	Vertex<T, W>* alvo = getVertex(dest); //compara ponteiros, sem ler a informacao de cada vertice
 
-	Vertex<T>* v = getVertex(s);
-	v->dist = 0;
-	vector<Vertex<T>*> q;
-	q.push_back(v);
-	make_heap(q.begin(), q.end(), vertex_greater_than<long double>()); //construir heap
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	Q &q = ws.getQueue();
+	QueuePolicy<Q>::push(q, v->index, 0);
 
 	while (!q.empty()) {
-
-		pop_heap(q.begin(), q.end());
-		v = q[q.size() - 1];
-		q.pop_back();
-		if (v->info == dest)
+		W dv;
+		v = vertexSet[QueuePolicy<Q>::pop(q, dv)];
+		//filas sem decrease-key: entrada antiga de um vertice que ja foi melhorado
+		if (!QueuePolicy<Q>::DECREASE_KEY && dv != ws.getDist(v->index))
+			continue;
+		if (v == alvo)
 			break;
 
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (v->dist + v->adj[i].weight < w->dist) {
-				w->dist = v->dist + v->adj[i].weight;
-				w->path = v;
-				if (!w->processing) {
-					q.push_back(w); //acrescenta
-					w->processing = true;
-				} // decrese key ou atualiza depois de introduzir w
-				make_heap(q.begin(), q.end(),
-						vertex_greater_than<long double>());
+			unsigned int w = v->adj[i].destIndex;
+			W nova = dv + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v->index);
+				QueuePolicy<Q>::push(q, w, nova); //decrease key
 			}
 		}
 	}
 
 }
 
-template<class T>
-int Graph<T>::edgeCost(int i, int j) {
-	if (i == j)
-		return 0;
+/**
+ * Original version of dijkstraShortestPath, which rebuilds the whole heap with make_heap after
+ * every relaxation. Only kept as a reference for the execution time tests.
+ */
+template<class T, class W>
+void Graph<T, W>::dijkstraShortestPathMakeHeap(const T& s, const T& dest,
+		SearchWorkspace<W> &ws) const {
+	ws.beginQuery(vertexSet.size());
+	vector<bool> processing(vertexSet.size(), false); //estao na fila de espera
 
-	for (unsigned int indice = 0; indice < vertexSet[i]->adj.size(); indice++) {
-		if (vertexSet[i]->adj[indice].dest->info == vertexSet[j]->info) {
-			return vertexSet[i]->adj[indice].weight;
-		}
-	}
+	Vertex<T, W>* v = getVertex(s);
+	if (v == NULL)
+		return;
 
-	return INT_INFINITY;
-}
+	//min-heap pela distancia atual
+	auto maior = [&ws](Vertex<T, W> * a, Vertex<T, W> * b) {
+		return ws.getDist(a->index) > ws.getDist(b->index);
+	};
 
-template<class T>
-void Graph<T>::floydWarshallShortestPath() {
-	//inicia distancias
-	distancias.clear();
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vector<long double> dist;
-		dist.clear();
-		for (unsigned int j = 0; j < vertexSet.size(); j++) {
-			dist.push_back(edgeCost(i, j));
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	vector<Vertex<T, W>*> q;
+	q.push_back(v);
+	make_heap(q.begin(), q.end(), maior); //construir heap
+
+	while (!q.empty()) {
+
+		pop_heap(q.begin(), q.end(), maior);
+		v = q[q.size() - 1];
+		q.pop_back();
+		processing[v->index] = false;
+		if (v->info == dest)
+			break;
+
+		for (unsigned int i = 0; i < v->adj.size(); i++) {
+			unsigned int w = v->adj[i].destIndex;
+			W nova = ws.getDist(v->index) + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v->index);
+				if (!processing[w]) {
+					q.push_back(vertexSet[w]); //acrescenta
+					processing[w] = true;
+				} // decrese key ou atualiza depois de introduzir w
+				make_heap(q.begin(), q.end(), maior);
+			}
 		}
-		distancias.push_back(dist);
 	}
 
-	//inicia precedentes
-	precedentes.clear();
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vector<int> prec;
-		prec.clear();
-		for (unsigned int j = 0; j < vertexSet.size(); j++) {
-			prec.push_back(i); //anterior de (i,j) comeca por ser i.
-		}
-		precedentes.push_back(prec);
-	}
-
-//	cout << endl << "INI DISTANCIAS" << endl;
-//	for (unsigned int i = 0; i < precedentes.size(); i++) {
-//		for (unsigned int j = 0; j < precedentes.size(); j++) {
-//			if (distancias[i][j] == INT_INFINITY)
-//				cout << "INF" << " ";
-//			else
-//				cout << distancias[i][j] << " ";
-//		}
-//
-//		cout << endl;
-//	}
-//
-//	cout << endl << "INI PRECEDENCIAS" << endl;
-//	for (unsigned int i = 0; i < precedentes.size(); i++) {
-//		for (unsigned int j = 0; j < precedentes.size(); j++) {
-//			cout << precedentes[i][j] << " ";
-//		}
-//
-//		cout << endl;
-//	}
+}
+/**
+ * @brief All pairs shortest paths (blocked Floyd-Warshall, see floydWarshallBlocked and
+ * floydWarshallPredecessors).
+ * The result is kept until the graph changes, so it is only recomputed when getVersion() is
+ * different from the version it was computed for.
+ */
+template<class T, class W>
+void Graph<T, W>::floydWarshallShortestPath() {
+	if (floydVersao == versao)
+		return;
 
-	//atualiza matrizes
-	for (unsigned int k = 0; k < vertexSet.size(); k++) { //K=0 OU K=1 d pq k=0 esta inerente
-		for (unsigned int i = 0; i < vertexSet.size(); i++) {
-			for (unsigned int j = 0; j < vertexSet.size(); j++) {
-				if (distancias[i][j] > (distancias[i][k] + distancias[k][j])) {
-					distancias[i][j] = (distancias[i][k] + distancias[k][j]);
-					precedentes[i][j] = precedentes[k][j];
-				}
+	unsigned int n = vertexSet.size();
+	floydStride = floydWarshallStride(n);
+	size_t tamanho = (size_t) floydStride * floydStride;
+	distancias.assign(tamanho, numeric_limits<float>::infinity());
+	arestasFloyd.assign(tamanho, FW_SEM_CAMINHO);
+	precedentes.resize(tamanho);
+
+	//inicia distancias com as arestas, e guarda as arestas que chegam a cada vertice
+	vector<vector<pair<unsigned int, float> > > entradas(n);
+	for (unsigned int i = 0; i < n; i++) {
+		distancias[(size_t) i * floydStride + i] = 0;
+		arestasFloyd[(size_t) i * floydStride + i] = 0;
+		for (unsigned int e = 0; e < vertexSet[i]->adj.size(); e++) {
+			size_t pos = (size_t) i * floydStride
+					+ vertexSet[i]->adj[e].destIndex;
+			float peso = floydWarshallWeight(
+					WeightTraits<W>::toHours(vertexSet[i]->adj[e].weight));
+			if (peso < distancias[pos]) {
+				distancias[pos] = peso;
+				arestasFloyd[pos] = 1;
 			}
+			entradas[vertexSet[i]->adj[e].destIndex].push_back(
+					make_pair(i, peso));
 		}
 	}
 
+	//atualiza matrizes
+	ThreadPool pool(thread::hardware_concurrency());
+	floydWarshallBlocked(&distancias[0], &arestasFloyd[0], floydStride, pool);
+	floydWarshallPredecessors(&distancias[0], &arestasFloyd[0], floydStride,
+			entradas, &precedentes[0], pool);
+	floydVersao = versao;
 }
 
-template<class T>
-void Graph<T>::getPathTo(Vertex<T>* origin, list<T>& res) {
+template<class T, class W>
+void Graph<T, W>::getPathTo(Vertex<T, W>* origin, list<T>& res) {
 }
 
-template<class T>
-vector<T> Graph<T>::getfloydWarshallPath(const T& origin, const T& dest) {
+template<class T, class W>
+vector<T> Graph<T, W>::getfloydWarshallPath(const T& origin, const T& dest) {
 	floydWarshallShortestPath();
 
-	unsigned int inicio = INT_MAX, fim = INT_MAX;
 	vector<T> res;
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		if (origin == vertexSet[i]->info)
-			inicio = i;
-		if (dest == vertexSet[i]->info)
-			fim = i;
-
-	}
-	if (inicio == INT_INFINITY || fim == INT_INFINITY)
+	Vertex<T, W>* vOrigin = getVertex(origin);
+	Vertex<T, W>* vDest = getVertex(dest);
+	if (vOrigin == NULL || vDest == NULL)
+		return res;
+	unsigned int inicio = vOrigin->index, fim = vDest->index;
+	if (distancias[(size_t) inicio * floydStride + fim]
+			== numeric_limits<float>::infinity())
 		return res;
-
-//	cout << endl << "DISTANCIAS" << endl;
-//	for (unsigned int i = 0; i < precedentes.size(); i++) {
-//		for (unsigned int j = 0; j < precedentes.size(); j++) {
-//			if (distancias[i][j] == INT_INFINITY)
-//				cout << "INF" << " ";
-//			else
-//				cout << distancias[i][j] << " ";
-//		}
-//
-//		cout << endl;
-//	}
-//
-//	cout << endl << "PRECEDENCIAS" << endl;
-//	for (unsigned int i = 0; i < precedentes.size(); i++) {
-//		for (unsigned int j = 0; j < precedentes.size(); j++) {
-//			cout << precedentes[i][j] << " ";
-//		}
-//
-//		cout << endl;
-//	}
-//	cout << "inicio:" << inicio << " fim:" << fim << endl;
-//
-//	cout << endl << "VALORES" << endl;
-//	for (unsigned int i = 0; i < precedentes.size(); i++) {
-//		cout << vertexSet[i]->info << " ";
-//	}
-//	cout << endl;
 
 	list<T> listaBackwards;
 	listaBackwards.push_front(vertexSet[fim]->info);
 	while (inicio != fim) {
-		fim = precedentes[inicio][fim];
+		fim = precedentes[(size_t) inicio * floydStride + fim];
+		if (fim == UINT_MAX) //nao devia acontecer, ha sempre um predecessor mais perto
+			return res;
 		listaBackwards.push_front(vertexSet[fim]->info);
 	}
 	while (!listaBackwards.empty()) {
@@ -862,115 +909,144 @@ vector<T> Graph<T>::getfloydWarshallPath(const T& origin, const T& dest) {
 	return res;
 }
 
+/**
+ * Heuristic policy of Graph::A_star: called with a vertex (of a graph with any weight type), returns a
+ * lower bound of its distance to the destination, in hours. This one is always 0 (A* becomes
+ * Dijkstra); a type of information can specialize it with a real bound (see heuristicFunc<NoInfo> in
+ * utils.h).
+ */
 template<class T>
 struct heuristicFunc {
-	T destino;
-	bool operator()(Vertex<T> * a, Vertex<T> * b) const {
-		return true;
-	}
-
-	long double operator()(Vertex<T> * a) const {
+	template<class V>
+	long double operator()(const V * a) const {
 		return 0.0;
 	}
 };
 
-template<class T>
-void Graph<T>::A_star_all(const T& origin, const T& dest) {
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-		vertexSet[i]->processing = false; //estao na fila de espera
-	}
+template<class T, class W>
+template<class H, class Q>
+void Graph<T, W>::A_star_all(const T& origin, const T& dest, const H &heuristic,
+		SearchWorkspace<W, Q> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-	Vertex<T>* v = getVertex(origin);
-	//Vertex<T>* des = getVertex(dest);
+	Vertex<T, W>* v = getVertex(origin);
+	//Vertex<T, W>* des = getVertex(dest);
 	if (v == NULL)
 		return;
 
-	v->dist = 0;
-	vector<Vertex<T>*> q;
-	q.push_back(v);
-	make_heap(q.begin(), q.end(), vertex_greater_than_A<long double>()); //construir heap
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	Q &q = ws.getQueue();
+	ws.setEstimate(v->index, WeightTraits<W>::fromEstimate(heuristic(v)));
+	QueuePolicy<Q>::push(q, v->index, ws.getEstimate(v->index));
 
 	while (!q.empty()) {
-		pop_heap(q.begin(), q.end());
-		v = q[q.size() - 1];
-		q.pop_back();
+		W chave;
+		v = vertexSet[QueuePolicy<Q>::pop(q, chave)];
+		W dv = ws.getDist(v->index);
+		//filas sem decrease-key: entrada antiga de um vertice que ja foi melhorado
+		if (!QueuePolicy<Q>::DECREASE_KEY && chave != dv + ws.getEstimate(v->index))
+			continue;
 
 		//TODO alterar para encontrar o destino !!!
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (v->dist + v->adj[i].weight < w->dist) {
-				w->dist = v->dist + v->adj[i].weight;
-				w->path = v;
-				if (!w->processing) {
-					q.push_back(w); //acrescenta
-					w->processing = true;
-				} // decrese key ou atualiza depois de introduzir w
-				make_heap(q.begin(), q.end(),
-						vertex_greater_than_A<long double>());
+			unsigned int w = v->adj[i].destIndex;
+			W nova = dv + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				//a heuristica so e calculada na primeira vez que w e alcancado
+				if (!ws.reached(w))
+					ws.setEstimate(w,
+							WeightTraits<W>::fromEstimate(heuristic(v->adj[i].dest)));
+				ws.setDist(w, nova, v->index);
+				QueuePolicy<Q>::push(q, w, nova + ws.getEstimate(w)); //decrease key
 			}
 		}
 	}
 }
+template<class T, class W>
+template<class H, class Q>
+void Graph<T, W>::A_star(const T& origin, const T& dest, const H &heuristic,
+		SearchWorkspace<W, Q> &ws) const {
+	ws.beginQuery(vertexSet.size());
 
-template<class T>
-void Graph<T>::A_star(const T& origin, const T& dest) {
-	for (unsigned int i = 0; i < vertexSet.size(); i++) {
-		vertexSet[i]->path = NULL;
-		vertexSet[i]->dist = INT_INFINITY;
-		vertexSet[i]->processing = false; //estao na fila de espera
-	}
-
-	Vertex<T>* v = getVertex(origin);
+	Vertex<T, W>* v = getVertex(origin);
 	if (v == NULL)
 		return;
+	Vertex<T, W>* alvo = getVertex(dest);
 
-	v->dist = 0;
-	vector<Vertex<T>*> q;
-	q.push_back(v);
-	make_heap(q.begin(), q.end(), vertex_greater_than_A<long double>()); //construir heap
+	ws.setDist(v->index, 0, ws.NO_VERTEX);
+	Q &q = ws.getQueue();
+	ws.setEstimate(v->index, WeightTraits<W>::fromEstimate(heuristic(v)));
+	QueuePolicy<Q>::push(q, v->index, ws.getEstimate(v->index));
 
 	while (!q.empty()) {
-		pop_heap(q.begin(), q.end());
-		v = q[q.size() - 1];
-		q.pop_back();
-		if (v->info == dest) //destino  o topo da fila de prioridade
+		W chave;
+		v = vertexSet[QueuePolicy<Q>::pop(q, chave)];
+		W dv = ws.getDist(v->index);
+		//filas sem decrease-key: entrada antiga de um vertice que ja foi melhorado
+		if (!QueuePolicy<Q>::DECREASE_KEY && chave != dv + ws.getEstimate(v->index))
+			continue;
+		if (v == alvo) //destino  o topo da fila de prioridade
 			break;
 
 		for (unsigned int i = 0; i < v->adj.size(); i++) {
-			Vertex<T>* w = v->adj[i].dest;
-			if (v->dist + v->adj[i].weight < w->dist) {
-				w->dist = v->dist + v->adj[i].weight;
-				w->path = v;
-				if (!w->processing) {
-					//TODO MAYBE ACRESCENTAR LAT E LONG o vertex
-					q.push_back(w); //acrescenta
-					w->processing = true;
-				} // decrese key ou atualiza depois de introduzir w
-				make_heap(q.begin(), q.end(),
-						vertex_greater_than_A<long double>());
+			unsigned int w = v->adj[i].destIndex;
+			W nova = dv + v->adj[i].weight;
+			if (nova < ws.getDist(w)) {
+				//a heuristica so e calculada na primeira vez que w e alcancado
+				if (!ws.reached(w))
+					ws.setEstimate(w,
+							WeightTraits<W>::fromEstimate(heuristic(v->adj[i].dest)));
+				ws.setDist(w, nova, v->index);
+				QueuePolicy<Q>::push(q, w, nova + ws.getEstimate(w)); //decrease key
 			}
 		}
 	}
 }
+template<class T, class W>
+template<class H, class Q>
+vector<T> Graph<T, W>::getA_starPath(const T& origin, const T& dest,
+		const H &heuristic, SearchWorkspace<W, Q> &ws) const {
+	A_star(origin, dest, heuristic, ws);
+	return getPath(origin, dest, ws);
+}
 
-template<class T>
-vector<T> Graph<T>::getA_starPath(const T& origin, const T& dest) {
-	A_star(origin, dest);
-	return getPath(origin, dest);
+template<class T, class W>
+template<class Q>
+vector<T> Graph<T, W>::getDijkstraPath(const T& origin, const T& dest,
+		SearchWorkspace<W, Q> &ws) const {
+	dijkstraShortestPath(origin, dest, ws);
+	return getPath(origin, dest, ws);
 }
 
-template<class T>
-vector<T> Graph<T>::getDijkstraPath(const T& origin, const T& dest) {
-	dijkstraShortestPath(origin, dest);
-	return getPath(origin, dest);
+template<class T, class W>
+vector<T> Graph<T, W>::getDijkstraPathMakeHeap(const T& origin, const T& dest,
+		SearchWorkspace<W> &ws) const {
+	dijkstraShortestPathMakeHeap(origin, dest, ws);
+	return getPath(origin, dest, ws);
 }
 
-template<class T>
-vector<T> Graph<T>::getDijkstraPathAll(const T& origin, const T& dest) {
-	dijkstraShortestPath_all(origin);
-	return getPath(origin, dest);
+template<class T, class W>
+vector<T> Graph<T, W>::getDijkstraPathAll(const T& origin, const T& dest,
+		SearchWorkspace<W> &ws) const {
+	dijkstraShortestPath_all(origin, ws);
+	return getPath(origin, dest, ws);
+}
+
+/**
+ * @brief Copies the vertices (in the same order, so with the same indices) and the edges of this graph
+ * into res, which must be empty, converting the weights to its type (see WeightTraits).
+ */
+template<class T, class W>
+template<class W2>
+void Graph<T, W>::copyTo(Graph<T, W2> &res) const {
+	res.reserve(vertexSet.size());
+	for (unsigned int i = 0; i < vertexSet.size(); i++)
+		res.addVertex(vertexSet[i]->info);
+	for (unsigned int i = 0; i < vertexSet.size(); i++)
+		for (unsigned int j = 0; j < vertexSet[i]->adj.size(); j++)
+			res.addEdge(vertexSet[i]->info, vertexSet[i]->adj[j].dest->info,
+					WeightTraits<W>::toHours(vertexSet[i]->adj[j].weight),
+					vertexSet[i]->adj[j].id);
 }
 
 #endif /* GRAPH_H_ */
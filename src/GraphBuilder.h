@@ -0,0 +1,138 @@
+/*
+ * GraphBuilder.h
+ */
+#ifndef SRC_GRAPHBUILDER_H_
+#define SRC_GRAPHBUILDER_H_
+
+#include <vector>
+#include <algorithm>
+#include "Graph.h"
+
+using namespace std;
+
+#define CONSTRUTOR_BLOCO 1024 //arestas cujos pesos sao pedidos de uma vez
+
+/** @file */
+
+/**
+ * Adds many edges to the vertices of a graph at once.
+ * The edges are only collected (source, destination and id, by vertex index) by addEdge; build() sorts
+ * them by (source, destination), keeps one edge per pair (the last one added, like a remove followed by
+ * an add would), computes the weights a block of edges at a time (so they can be computed together, see
+ * GeoPoints::distancesKm) and appends the edges to the graph, with every adjacency
+ * list allocated with its final size. Loading m edges takes O(m log m), instead of a scan of the
+ * adjacency list per edge.
+ * Only the edges given to the builder are deduplicated, not the ones the graph already had.
+ */
+template<class T>
+class GraphBuilder {
+	struct PendingEdge {
+		unsigned int origem, destino;
+		unsigned int ordem; //ordem de chegada, entre arestas repetidas fica a ultima
+		unsigned long long id;
+		bool operator<(const PendingEdge &outra) const {
+			if (origem != outra.origem)
+				return origem < outra.origem;
+			if (destino != outra.destino)
+				return destino < outra.destino;
+			return ordem < outra.ordem;
+		}
+	};
+
+	Graph<T> &grafo;
+	vector<PendingEdge> arestas;
+	unsigned int repetidas;
+public:
+	explicit GraphBuilder(Graph<T> &grafo) :
+			grafo(grafo), repetidas(0) {
+	}
+
+	void reserve(unsigned int numEdges) {
+		arestas.reserve(numEdges);
+	}
+	bool addEdge(const T &sourc, const T &dest, unsigned long long id);
+	template<class F>
+	void build(F peso);
+
+	/**
+	 * @return the edges dropped by the last build() for repeating the source and destination of another
+	 */
+	unsigned int getNumDuplicates() const {
+		return repetidas;
+	}
+};
+
+/**
+ * @brief Collects the edge from sourc to dest, both already in the graph.
+ * @return false if either vertex isn't in the graph (the edge is ignored)
+ */
+template<class T>
+bool GraphBuilder<T>::addEdge(const T &sourc, const T &dest,
+		unsigned long long id) {
+	Vertex<T> *vS = grafo.getVertex(sourc);
+	Vertex<T> *vD = grafo.getVertex(dest);
+	if (vS == NULL || vD == NULL)
+		return false;
+	PendingEdge e;
+	e.origem = vS->getIndex();
+	e.destino = vD->getIndex();
+	e.ordem = arestas.size();
+	e.id = id;
+	arestas.push_back(e);
+	return true;
+}
+
+/**
+ * @brief Adds the collected edges to the graph, one per (source, destination), and empties the builder.
+ * @param peso void(const unsigned int *origens, const unsigned int *destinos, unsigned int n, double *pesos),
+ * which sets pesos[i] to the weight of an edge between the vertices with indices origens[i] and destinos[i],
+ * for i < n (at most CONSTRUTOR_BLOCO)
+ */
+template<class T>
+template<class F>
+void GraphBuilder<T>::build(F peso) {
+	sort(arestas.begin(), arestas.end());
+
+	//fica a ultima de cada par, e conta o grau final de cada vertice
+	ArrayView<Vertex<T> *> vertices = grafo.getVertexSet();
+	vector<unsigned int> grau(vertices.size(), 0);
+	unsigned int unicas = 0;
+	for (unsigned int i = 0; i < arestas.size(); i++) {
+		if (i + 1 < arestas.size() && arestas[i + 1].origem == arestas[i].origem
+				&& arestas[i + 1].destino == arestas[i].destino)
+			continue;
+		arestas[unicas++] = arestas[i];
+		grau[arestas[i].origem]++;
+	}
+	repetidas = arestas.size() - unicas;
+	arestas.resize(unicas);
+
+	for (unsigned int v = 0; v < vertices.size(); v++)
+		if (grau[v] > 0)
+			vertices[v]->adj.reserve(vertices[v]->adj.size() + grau[v]);
+	vector<unsigned int> origens(CONSTRUTOR_BLOCO), destinos(CONSTRUTOR_BLOCO);
+	vector<double> pesos(CONSTRUTOR_BLOCO);
+	for (unsigned int inicio = 0; inicio < arestas.size(); inicio +=
+			CONSTRUTOR_BLOCO) {
+		unsigned int n = arestas.size() - inicio;
+		if (n > CONSTRUTOR_BLOCO)
+			n = CONSTRUTOR_BLOCO;
+		for (unsigned int j = 0; j < n; j++) {
+			origens[j] = arestas[inicio + j].origem;
+			destinos[j] = arestas[inicio + j].destino;
+		}
+		peso(&origens[0], &destinos[0], n, &pesos[0]);
+		for (unsigned int j = 0; j < n; j++) {
+			Vertex<T> *vS = vertices[origens[j]];
+			Vertex<T> *vD = vertices[destinos[j]];
+			vS->addEdge(vD, pesos[j], arestas[inicio + j].id);
+			vD->indegree++;
+		}
+	}
+	grafo.numEdges += arestas.size();
+	grafo.versao++;
+
+	arestas.clear();
+}
+
+#endif /* SRC_GRAPHBUILDER_H_ */
@@ -0,0 +1,255 @@
+/*
+ * HubLabels.h
+ */
+#ifndef SRC_HUBLABELS_H_
+#define SRC_HUBLABELS_H_
+
+#include <vector>
+#include <limits>
+#include <unordered_map>
+#include "FrozenGraph.h"
+#include "ContractionHierarchy.h"
+#include "IndexedHeap.h"
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Hub labeling index over a routing snapshot.
+ *
+ * Every vertex v keeps an out label (hubs h with d(v,h)) and an in label (hubs h with d(h,v)), such
+ * that for every pair s, t some hub of the shortest path is in both L_out(s) and L_in(t). The distance
+ * is then min over the common hubs of d(s,h) + d(h,t), a merge-join of two short sorted arrays, with
+ * no search at all.
+ *
+ * The labels are built by pruned labeling: the vertices are taken from the most to the least
+ * important (reverse contraction order of a ContractionHierarchy) and each one runs a forward and a
+ * backward Dijkstra that stops at every vertex whose distance the labels built so far already
+ * cover. Hubs are numbered by that order, so the labels come out sorted by hub.
+ */
+template<class T>
+class HubLabels {
+	const FrozenGraph<T> * grafo;
+	vector<unsigned int> ordem; //hub -> vertice
+
+	//labels em CSR: as entradas do vertice v estao em [offsets[v], offsets[v+1]), por hub crescente
+	vector<unsigned int> outOffsets;
+	vector<unsigned int> outHubs;
+	vector<float> outDists;
+	vector<unsigned int> inOffsets;
+	vector<unsigned int> inHubs;
+	vector<float> inDists;
+
+	struct Entrada {
+		unsigned int hub;
+		float dist;
+		Entrada(unsigned int hub, float dist) :
+				hub(hub), dist(dist) {
+		}
+	};
+
+	void prunedSearch(unsigned int h, bool reverse, vector<vector<Entrada> > &labels,
+			const vector<vector<Entrada> > &outros, vector<float> &hubDist,
+			IndexedHeap<float> &q, vector<float> &dist) const;
+	static void flatten(const vector<vector<Entrada> > &labels,
+			vector<unsigned int> &offsets, vector<unsigned int> &hubs,
+			vector<float> &dists);
+public:
+	static const unsigned int NO_VERTEX = UINT_MAX;
+
+	HubLabels(const FrozenGraph<T> &grafo, const ContractionHierarchy<T> &ch);
+
+	float query(unsigned int s, unsigned int t) const;
+	vector<T> getHubLabelPath(const T &origin, const T &dest) const;
+
+	unsigned int getNumEntries() const {
+		return outHubs.size() + inHubs.size();
+	}
+	size_t getMemoryBytes() const;
+};
+
+template<class T>
+const unsigned int HubLabels<T>::NO_VERTEX;
+
+/**
+ * @brief Pruned Dijkstra from the vertex of hub h (over the reverse adjacency if reverse is true).
+ * A vertex v reached at distance d gets (h, d) in its label unless the labels already give a
+ * distance <= d, in which case the search does not continue from v.
+ * @param labels the labels being filled: in labels for the forward search, out labels for the backward one
+ * @param outros the labels of the other direction, read for h
+ * @param hubDist scratch, one position per hub, infinity on entry and on exit
+ */
+template<class T>
+void HubLabels<T>::prunedSearch(unsigned int h, bool reverse,
+		vector<vector<Entrada> > &labels, const vector<vector<Entrada> > &outros,
+		vector<float> &hubDist, IndexedHeap<float> &q,
+		vector<float> &dist) const {
+	unsigned int origem = ordem[h];
+	const vector<Entrada> &labelOrigem = outros[origem];
+	for (unsigned int i = 0; i < labelOrigem.size(); i++)
+		hubDist[labelOrigem[i].hub] = labelOrigem[i].dist;
+
+	vector<unsigned int> tocados;
+	dist[origem] = 0;
+	tocados.push_back(origem);
+	q.insert(origem, 0);
+	while (!q.empty()) {
+		unsigned int v = q.extractMin();
+		float dv = dist[v];
+
+		//poda: os hubs anteriores ja cobrem este par?
+		bool coberto = false;
+		for (unsigned int i = 0; i < labels[v].size() && !coberto; i++)
+			if (hubDist[labels[v][i].hub] + labels[v][i].dist <= dv)
+				coberto = true;
+		if (coberto)
+			continue;
+		labels[v].push_back(Entrada(h, dv));
+
+		unsigned int inicio = reverse ? grafo->revEdgesBegin(v) : grafo->edgesBegin(v);
+		unsigned int fim = reverse ? grafo->revEdgesEnd(v) : grafo->edgesEnd(v);
+		for (unsigned int e = inicio; e < fim; e++) {
+			unsigned int w = reverse ? grafo->getSource(e) : grafo->getTarget(e);
+			float nova = dv + (reverse ? grafo->getRevWeight(e) : grafo->getWeight(e));
+			if (nova < dist[w]) {
+				if (dist[w] == numeric_limits<float>::infinity())
+					tocados.push_back(w);
+				dist[w] = nova;
+				q.insertOrDecrease(w, nova);
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < tocados.size(); i++)
+		dist[tocados[i]] = numeric_limits<float>::infinity();
+	for (unsigned int i = 0; i < labelOrigem.size(); i++)
+		hubDist[labelOrigem[i].hub] = numeric_limits<float>::infinity();
+}
+
+template<class T>
+void HubLabels<T>::flatten(const vector<vector<Entrada> > &labels,
+		vector<unsigned int> &offsets, vector<unsigned int> &hubs,
+		vector<float> &dists) {
+	offsets.push_back(0);
+	for (unsigned int v = 0; v < labels.size(); v++) {
+		for (unsigned int i = 0; i < labels[v].size(); i++) {
+			hubs.push_back(labels[v][i].hub);
+			dists.push_back(labels[v][i].dist);
+		}
+		offsets.push_back(hubs.size());
+	}
+}
+
+/**
+ * @brief Builds the labels by pruned labeling, in the reverse contraction order of ch.
+ * @param grafo the routing snapshot; it must outlive the index
+ * @param ch a hierarchy built over the same snapshot, used only for the vertex order
+ */
+template<class T>
+HubLabels<T>::HubLabels(const FrozenGraph<T> &grafo,
+		const ContractionHierarchy<T> &ch) :
+		grafo(&grafo) {
+	unsigned int n = grafo.getNumVertex();
+	ordem.resize(n);
+	for (unsigned int v = 0; v < n; v++)
+		ordem[n - 1 - ch.getRank(v)] = v;
+
+	vector<vector<Entrada> > labelsOut(n), labelsIn(n);
+	vector<float> hubDist(n, numeric_limits<float>::infinity());
+	vector<float> dist(n, numeric_limits<float>::infinity());
+	IndexedHeap<float> q(n);
+	for (unsigned int h = 0; h < n; h++) {
+		prunedSearch(h, false, labelsIn, labelsOut, hubDist, q, dist);
+		prunedSearch(h, true, labelsOut, labelsIn, hubDist, q, dist);
+	}
+
+	flatten(labelsOut, outOffsets, outHubs, outDists);
+	flatten(labelsIn, inOffsets, inHubs, inDists);
+}
+
+/**
+ * @brief Distance from s to t by a merge-join of L_out(s) and L_in(t).
+ * @return the distance (infinity if t is unreachable)
+ */
+template<class T>
+float HubLabels<T>::query(unsigned int s, unsigned int t) const {
+	float res = numeric_limits<float>::infinity();
+	unsigned int i = outOffsets[s], fimI = outOffsets[s + 1];
+	unsigned int j = inOffsets[t], fimJ = inOffsets[t + 1];
+	while (i < fimI && j < fimJ) {
+		if (outHubs[i] < inHubs[j])
+			i++;
+		else if (outHubs[i] > inHubs[j])
+			j++;
+		else {
+			float d = outDists[i] + inDists[j];
+			if (d < res)
+				res = d;
+			i++;
+			j++;
+		}
+	}
+	return res;
+}
+
+/**
+ * @brief Shortest path, rebuilt with distance queries: a depth-first search from s that only follows
+ * tight edges, those (v,w) with w(v,w) + d(w,t) = d(v,t), so every vertex it reaches is on a shortest
+ * path. It has to backtrack only when it goes around a cycle of zero weight transfers.
+ * @return the path, or an empty vector if there is none
+ */
+template<class T>
+vector<T> HubLabels<T>::getHubLabelPath(const T &origin, const T &dest) const {
+	vector<T> res;
+	unsigned int s = grafo->getIndex(origin), t = grafo->getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX
+			|| query(s, t) == numeric_limits<float>::infinity())
+		return res;
+
+	//pilha da pesquisa: vertices do caminho atual e a proxima aresta a tentar em cada um
+	vector<unsigned int> caminho(1, s);
+	vector<unsigned int> proximaAresta(1, grafo->edgesBegin(s));
+	vector<float> falta(1, query(s, t));
+	unordered_map<unsigned int, bool> visitados;
+	visitados[s] = true;
+	while (!caminho.empty() && caminho.back() != t) {
+		unsigned int v = caminho.back();
+		unsigned int &e = proximaAresta.back();
+		if (e == grafo->edgesEnd(v)) {
+			caminho.pop_back();
+			proximaAresta.pop_back();
+			falta.pop_back();
+			continue;
+		}
+		unsigned int w = grafo->getTarget(e);
+		float peso = grafo->getWeight(e);
+		e++;
+		if (visitados.count(w))
+			continue;
+		float dw = query(w, t);
+		//tolerancia para os arredondamentos das somas em float
+		if (peso + dw > falta.back() * (1 + 1e-5f) + 1e-7f)
+			continue;
+		visitados[w] = true;
+		caminho.push_back(w);
+		proximaAresta.push_back(grafo->edgesBegin(w));
+		falta.push_back(dw);
+	}
+
+	for (unsigned int i = 0; i < caminho.size(); i++)
+		res.push_back(grafo->getInfo(caminho[i]));
+	return res;
+}
+
+/**
+ * @return the bytes taken by the labels (entries and offsets) and the hub order
+ */
+template<class T>
+size_t HubLabels<T>::getMemoryBytes() const {
+	return (outHubs.size() + inHubs.size()) * (sizeof(unsigned int) + sizeof(float))
+			+ (outOffsets.size() + inOffsets.size() + ordem.size())
+					* sizeof(unsigned int);
+}
+
+#endif /* SRC_HUBLABELS_H_ */
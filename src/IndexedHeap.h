@@ -0,0 +1,181 @@
+/*
+ * IndexedHeap.h
+ */
+#ifndef SRC_INDEXEDHEAP_H_
+#define SRC_INDEXEDHEAP_H_
+
+#include <vector>
+#include <limits.h>
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Addressable d-ary min-heap over the integers 0..n-1 (vertex indices).
+ * Keeps, for each element, its key and its position in the heap, so the key of an element
+ * already in the queue can be decreased in O(log n) without rebuilding the heap.
+ * D is the number of children of each node; 4 gives shallower trees and fewer cache misses
+ * than a binary heap for the Dijkstra/A* access pattern (many decrease-keys, fewer pops).
+ */
+template<class K, unsigned int D = 4>
+class IndexedHeap {
+	vector<unsigned int> heap;
+	vector<K> keys;
+	vector<unsigned int> pos;
+
+	void siftUp(unsigned int i);
+	void siftDown(unsigned int i);
+	void place(unsigned int i, unsigned int elem) {
+		heap[i] = elem;
+		pos[elem] = i;
+	}
+public:
+	static const unsigned int NOT_IN_HEAP = UINT_MAX;
+
+	explicit IndexedHeap(unsigned int n = 0);
+	void resize(unsigned int n);
+	void clear();
+
+	bool empty() const {
+		return heap.empty();
+	}
+	unsigned int size() const {
+		return heap.size();
+	}
+	bool contains(unsigned int elem) const {
+		return pos[elem] != NOT_IN_HEAP;
+	}
+	K getKey(unsigned int elem) const {
+		return keys[elem];
+	}
+	K minKey() const {
+		return keys[heap[0]];
+	}
+	unsigned int top() const {
+		return heap[0];
+	}
+
+	void insert(unsigned int elem, K key);
+	void decreaseKey(unsigned int elem, K key);
+	bool insertOrDecrease(unsigned int elem, K key);
+	unsigned int extractMin();
+};
+
+template<class K, unsigned int D>
+const unsigned int IndexedHeap<K, D>::NOT_IN_HEAP;
+
+template<class K, unsigned int D>
+IndexedHeap<K, D>::IndexedHeap(unsigned int n) :
+		keys(n), pos(n, NOT_IN_HEAP) {
+}
+
+/**
+ * @brief Changes the range of elements to 0..n-1. Elements still in the heap are discarded.
+ */
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::resize(unsigned int n) {
+	clear();
+	keys.resize(n);
+	pos.resize(n, NOT_IN_HEAP);
+}
+
+/**
+ * @brief Empties the heap. Only touches the elements that were still inside it.
+ */
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::clear() {
+	for (unsigned int i = 0; i < heap.size(); i++)
+		pos[heap[i]] = NOT_IN_HEAP;
+	heap.clear();
+}
+
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::siftUp(unsigned int i) {
+	unsigned int elem = heap[i];
+	while (i > 0) {
+		unsigned int parent = (i - 1) / D;
+		if (!(keys[elem] < keys[heap[parent]]))
+			break;
+		place(i, heap[parent]);
+		i = parent;
+	}
+	place(i, elem);
+}
+
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::siftDown(unsigned int i) {
+	unsigned int elem = heap[i];
+	unsigned int n = heap.size();
+	while (true) {
+		unsigned int first = i * D + 1;
+		if (first >= n)
+			break;
+		unsigned int last = (first + D < n) ? first + D : n;
+		unsigned int best = first;
+		for (unsigned int c = first + 1; c < last; c++)
+			if (keys[heap[c]] < keys[heap[best]])
+				best = c;
+		if (!(keys[heap[best]] < keys[elem]))
+			break;
+		place(i, heap[best]);
+		i = best;
+	}
+	place(i, elem);
+}
+
+/**
+ * @brief Inserts an element that is not in the heap.
+ */
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::insert(unsigned int elem, K key) {
+	keys[elem] = key;
+	heap.push_back(elem);
+	pos[elem] = heap.size() - 1;
+	siftUp(heap.size() - 1);
+}
+
+/**
+ * @brief Lowers the key of an element already in the heap.
+ */
+template<class K, unsigned int D>
+void IndexedHeap<K, D>::decreaseKey(unsigned int elem, K key) {
+	keys[elem] = key;
+	siftUp(pos[elem]);
+}
+
+/**
+ * @brief Inserts the element, or lowers its key if it is already in the heap and the new key is smaller.
+ * @return true if the heap changed
+ */
+template<class K, unsigned int D>
+bool IndexedHeap<K, D>::insertOrDecrease(unsigned int elem, K key) {
+	if (!contains(elem)) {
+		insert(elem, key);
+		return true;
+	}
+	if (key < keys[elem]) {
+		decreaseKey(elem, key);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Removes the element with the smallest key.
+ * @return the element removed
+ */
+template<class K, unsigned int D>
+unsigned int IndexedHeap<K, D>::extractMin() {
+	unsigned int minElem = heap[0];
+	pos[minElem] = NOT_IN_HEAP;
+	unsigned int last = heap.back();
+	heap.pop_back();
+	if (!heap.empty()) {
+		heap[0] = last;
+		siftDown(0);
+	}
+	return minElem;
+}
+
+#endif /* SRC_INDEXEDHEAP_H_ */
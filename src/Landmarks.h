@@ -0,0 +1,261 @@
+/*
+ * Landmarks.h
+ */
+#ifndef SRC_LANDMARKS_H_
+#define SRC_LANDMARKS_H_
+
+#include <vector>
+#include <cmath>
+#include <limits.h>
+#include "FrozenGraph.h"
+#include "IndexedHeap.h"
+
+using namespace std;
+
+#define NUM_LANDMARKS 8
+
+/** @file */
+
+/**
+ * ALT (A*, Landmarks and Triangle inequality) preprocessing over a routing snapshot.
+ *
+ * For a few landmarks L it keeps d(L,v) and d(v,L) for every vertex v. By the triangle inequality,
+ * d(v,t) >= d(L,t) - d(L,v) and d(v,t) >= d(v,L) - d(t,L), so the largest of these differences over
+ * all the landmarks is a lower bound of the remaining distance that, unlike the straight line at
+ * subway speed, follows the weights of the graph.
+ *
+ * The landmarks are chosen by farthest selection among the vertices of the largest strongly connected
+ * component: each new landmark is the vertex farthest (in time, both ways) from the landmarks already
+ * chosen, so they end up spread over the map borders.
+ */
+template<class T>
+class Landmarks {
+	vector<unsigned int> landmarks;
+	//vertex-major: as distancias do vertice v estao em [v*k, (v+1)*k), lidas de uma vez pela heuristica
+	vector<float> fromLandmark;
+	vector<float> toLandmark;
+
+	static void oneToAll(const FrozenGraph<T> &grafo, unsigned int s,
+			bool reverse, float *dist);
+	static unsigned int largestComponent(const FrozenGraph<T> &grafo,
+			vector<bool> &nucleo);
+public:
+	Landmarks(const FrozenGraph<T> &grafo, unsigned int k = NUM_LANDMARKS);
+
+	unsigned int getNumLandmarks() const {
+		return landmarks.size();
+	}
+	unsigned int getLandmark(unsigned int i) const {
+		return landmarks[i];
+	}
+	float getFrom(unsigned int i, unsigned int v) const {
+		return fromLandmark[(size_t) v * landmarks.size() + i];
+	}
+	float getTo(unsigned int i, unsigned int v) const {
+		return toLandmark[(size_t) v * landmarks.size() + i];
+	}
+};
+
+/**
+ * @brief Dijkstra from s to every vertex (or, with reverse, from every vertex to s).
+ * @param dist output, one position per vertex (infinity for the unreachable ones)
+ */
+template<class T>
+void Landmarks<T>::oneToAll(const FrozenGraph<T> &grafo, unsigned int s,
+		bool reverse, float *dist) {
+	unsigned int n = grafo.getNumVertex();
+	for (unsigned int v = 0; v < n; v++)
+		dist[v] = numeric_limits<float>::infinity();
+	IndexedHeap<float> q(n);
+	dist[s] = 0;
+	q.insert(s, 0);
+	while (!q.empty()) {
+		unsigned int v = q.extractMin();
+		unsigned int inicio = reverse ? grafo.revEdgesBegin(v) : grafo.edgesBegin(v);
+		unsigned int fim = reverse ? grafo.revEdgesEnd(v) : grafo.edgesEnd(v);
+		for (unsigned int e = inicio; e < fim; e++) {
+			unsigned int w = reverse ? grafo.getSource(e) : grafo.getTarget(e);
+			float nova = dist[v]
+					+ (reverse ? grafo.getRevWeight(e) : grafo.getWeight(e));
+			if (nova < dist[w]) {
+				dist[w] = nova;
+				q.insertOrDecrease(w, nova);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Finds the largest strongly connected component (Kosaraju: a DFS over the edges, then one over
+ * the reverse edges by decreasing finish time, where each tree is a component).
+ * @param nucleo output, true for the vertices of the component
+ * @return a vertex of the component
+ */
+template<class T>
+unsigned int Landmarks<T>::largestComponent(const FrozenGraph<T> &grafo,
+		vector<bool> &nucleo) {
+	unsigned int n = grafo.getNumVertex();
+	vector<unsigned int> ordem, proxima(n), pilha;
+	vector<bool> visto(n, false);
+	ordem.reserve(n);
+	for (unsigned int r = 0; r < n; r++) {
+		if (visto[r])
+			continue;
+		visto[r] = true;
+		proxima[r] = grafo.edgesBegin(r);
+		pilha.push_back(r);
+		while (!pilha.empty()) {
+			unsigned int v = pilha.back();
+			if (proxima[v] < grafo.edgesEnd(v)) {
+				unsigned int w = grafo.getTarget(proxima[v]++);
+				if (!visto[w]) {
+					visto[w] = true;
+					proxima[w] = grafo.edgesBegin(w);
+					pilha.push_back(w);
+				}
+			} else {
+				ordem.push_back(v);
+				pilha.pop_back();
+			}
+		}
+	}
+
+	vector<unsigned int> componente(n, UINT_MAX);
+	unsigned int maior = 0, tamanhoMaior = 0, numComponentes = 0;
+	for (unsigned int i = n; i-- > 0;) {
+		unsigned int r = ordem[i];
+		if (componente[r] != UINT_MAX)
+			continue;
+		unsigned int tamanho = 0;
+		componente[r] = numComponentes;
+		pilha.push_back(r);
+		while (!pilha.empty()) {
+			unsigned int v = pilha.back();
+			pilha.pop_back();
+			tamanho++;
+			for (unsigned int e = grafo.revEdgesBegin(v); e < grafo.revEdgesEnd(v);
+					e++) {
+				unsigned int w = grafo.getSource(e);
+				if (componente[w] == UINT_MAX) {
+					componente[w] = numComponentes;
+					pilha.push_back(w);
+				}
+			}
+		}
+		if (tamanho > tamanhoMaior) {
+			tamanhoMaior = tamanho;
+			maior = r;
+		}
+		numComponentes++;
+	}
+	for (unsigned int v = 0; v < n; v++)
+		nucleo[v] = componente[v] == componente[maior];
+	return maior;
+}
+
+/**
+ * @brief Chooses k landmarks and computes their distances to and from every vertex.
+ * @param grafo the routing snapshot
+ * @param k number of landmarks (fewer if the largest strongly connected component has fewer vertices)
+ */
+template<class T>
+Landmarks<T>::Landmarks(const FrozenGraph<T> &grafo, unsigned int k) {
+	unsigned int n = grafo.getNumVertex();
+	if (k > n)
+		k = n;
+
+	fromLandmark.resize((size_t) k * n);
+	toLandmark.resize((size_t) k * n);
+
+	//so sao candidatos os vertices da maior componente fortemente conexa:
+	//fontes e becos sem saida dariam distancias num so sentido
+	vector<float> from(n), to(n);
+	vector<bool> nucleo(n, false);
+	unsigned int candidato = 0;
+	if (n > 0) {
+		unsigned int raiz = largestComponent(grafo, nucleo);
+		oneToAll(grafo, raiz, false, &from[0]);
+		oneToAll(grafo, raiz, true, &to[0]);
+		//o primeiro e o mais afastado da raiz
+		candidato = raiz;
+		for (unsigned int v = 0; v < n; v++)
+			if (nucleo[v] && from[v] + to[v] > from[candidato] + to[candidato])
+				candidato = v;
+	}
+
+	//distancia (ida e volta) de cada vertice ao landmark mais proximo
+	vector<float> proximidade(n, numeric_limits<float>::infinity());
+	vector<bool> escolhido(n, false);
+	for (unsigned int i = 0; i < k; i++) {
+		landmarks.push_back(candidato);
+		escolhido[candidato] = true;
+		oneToAll(grafo, candidato, false, &from[0]);
+		oneToAll(grafo, candidato, true, &to[0]);
+
+		float melhor = -1;
+		for (unsigned int v = 0; v < n; v++) {
+			fromLandmark[(size_t) v * k + i] = from[v];
+			toLandmark[(size_t) v * k + i] = to[v];
+			if (!nucleo[v])
+				continue;
+			if (from[v] + to[v] < proximidade[v])
+				proximidade[v] = from[v] + to[v];
+			if (proximidade[v] > melhor) {
+				melhor = proximidade[v];
+				candidato = v;
+			}
+		}
+		//todos os candidatos ja estao a distancia 0 de um landmark: outro seria repetido
+		if (melhor <= 0 || escolhido[candidato])
+			break;
+	}
+
+	//menos landmarks do que k: as distancias passam a ter landmarks.size() por vertice
+	unsigned int m = landmarks.size();
+	if (m < k) {
+		for (unsigned int v = 0; v < n; v++)
+			for (unsigned int i = 0; i < m; i++) {
+				fromLandmark[(size_t) v * m + i] = fromLandmark[(size_t) v * k + i];
+				toLandmark[(size_t) v * m + i] = toLandmark[(size_t) v * k + i];
+			}
+		fromLandmark.resize((size_t) m * n);
+		toLandmark.resize((size_t) m * n);
+	}
+}
+
+/**
+ * A* heuristic that takes the ALT lower bound towards a fixed destination. The distances of the
+ * destination to the landmarks are read once; the bound of each vertex is only computed when the
+ * search reaches it.
+ */
+template<class T>
+struct landmarkHeuristic {
+	const Landmarks<T> * alt;
+	unsigned int destino;
+	vector<float> fromDestino;
+	vector<float> toDestino;
+
+	landmarkHeuristic(const Landmarks<T> &alt, unsigned int destino) :
+			alt(&alt), destino(destino) {
+		for (unsigned int i = 0; i < alt.getNumLandmarks(); i++) {
+			fromDestino.push_back(alt.getFrom(i, destino));
+			toDestino.push_back(alt.getTo(i, destino));
+		}
+	}
+	float operator()(unsigned int v) const {
+		float res = 0;
+		for (unsigned int i = 0; i < fromDestino.size(); i++) {
+			float lv = alt->getFrom(i, v);
+			if (!std::isinf(fromDestino[i]) && !std::isinf(lv)
+					&& fromDestino[i] - lv > res)
+				res = fromDestino[i] - lv;
+			float vl = alt->getTo(i, v);
+			if (!std::isinf(vl) && !std::isinf(toDestino[i])
+					&& vl - toDestino[i] > res)
+				res = vl - toDestino[i];
+		}
+		return res;
+	}
+};
+
+#endif /* SRC_LANDMARKS_H_ */
@@ -0,0 +1,339 @@
+/*
+ * MapParser.h
+ */
+#ifndef SRC_MAPPARSER_H_
+#define SRC_MAPPARSER_H_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include "NoInfo.h"
+#include "aresta.h"
+#include "ThreadPool.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+#define PARSER_TAREFAS_POR_THREAD 4 //blocos de cada ficheiro por thread, para equilibrar a carga
+#define PARSER_MINIMO_BLOCO 65536 //bytes abaixo dos quais nao vale a pena dividir o ficheiro
+
+/** @file */
+
+/**
+ * Read-only view of a whole file in memory: mapped with mmap where there is one, read into a buffer
+ * otherwise (Windows). Like an ifstream, a file that can't be opened gives isOpen() false.
+ */
+class MappedFile {
+	const char *dados;
+	size_t tamanho;
+	vector<char> buffer; //so sem mmap
+	bool mapeado;
+	bool aberto;
+
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+public:
+	explicit MappedFile(const string &nome);
+	~MappedFile();
+
+	bool isOpen() const {
+		return aberto;
+	}
+	const char *data() const {
+		return dados;
+	}
+	size_t size() const {
+		return tamanho;
+	}
+};
+
+inline MappedFile::MappedFile(const string &nome) :
+		dados(NULL), tamanho(0), mapeado(false), aberto(false) {
+#ifndef _WIN32
+	int fd = open(nome.c_str(), O_RDONLY);
+	if (fd < 0)
+		return;
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0) {
+		void *p = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED) {
+			madvise(p, info.st_size, MADV_SEQUENTIAL);
+			dados = static_cast<const char *>(p);
+			tamanho = info.st_size;
+			mapeado = true;
+		}
+	}
+	close(fd);
+	if (mapeado) {
+		aberto = true;
+		return;
+	}
+#endif
+	FILE *f = fopen(nome.c_str(), "rb");
+	if (f == NULL)
+		return;
+	aberto = true;
+	char bloco[65536];
+	size_t lidos;
+	while ((lidos = fread(bloco, 1, sizeof(bloco), f)) > 0)
+		buffer.insert(buffer.end(), bloco, bloco + lidos);
+	fclose(f);
+	dados = buffer.empty() ? NULL : &buffer[0];
+	tamanho = buffer.size();
+}
+
+inline MappedFile::~MappedFile() {
+#ifndef _WIN32
+	if (mapeado)
+		munmap(const_cast<char *>(dados), tamanho);
+#endif
+}
+
+/**
+ * @brief Reads an unsigned integer at p (skipping spaces before it) and moves p past it.
+ */
+inline unsigned long long parseUnsigned(const char *&p, const char *fim) {
+	while (p < fim && (*p == ' ' || *p == '\t'))
+		p++;
+	unsigned long long res = 0;
+	while (p < fim && *p >= '0' && *p <= '9')
+		res = res * 10 + (*p++ - '0');
+	return res;
+}
+
+/**
+ * @brief Reads a decimal number (sign, digits and a point, no exponent) at p and moves p past it.
+ * The significant digits are read into an integer and divided once by a power of ten, both exact in a
+ * long double up to 19 digits, so the result is the correctly rounded value, the same as operator>>.
+ */
+inline long double parseDecimal(const char *&p, const char *fim) {
+	static const long double potencias[] = { 1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L,
+			1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L,
+			1e17L, 1e18L, 1e19L };
+	while (p < fim && (*p == ' ' || *p == '\t'))
+		p++;
+	bool negativo = false;
+	if (p < fim && (*p == '-' || *p == '+'))
+		negativo = *p++ == '-';
+	unsigned long long mantissa = 0;
+	int digitos = 0, decimais = 0, ignorados = 0;
+	bool ponto = false;
+	for (; p < fim; p++) {
+		if (*p == '.' && !ponto)
+			ponto = true;
+		else if (*p >= '0' && *p <= '9') {
+			if (digitos < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0)
+					digitos++;
+				if (ponto)
+					decimais++;
+			} else if (!ponto)
+				ignorados++; //digitos inteiros a mais, contam como zeros
+		} else
+			break;
+	}
+	long double res = mantissa;
+	if (ignorados > 0)
+		res *= potencias[ignorados < 19 ? ignorados : 19];
+	for (; decimais > 19; decimais -= 19)
+		res /= potencias[19];
+	if (decimais > 0)
+		res /= potencias[decimais];
+	return negativo ? -res : res;
+}
+
+/**
+ * @brief Moves p past the next ';' of the line (or to its end).
+ */
+inline void skipField(const char *&p, const char *fim) {
+	while (p < fim && *p != ';')
+		p++;
+	if (p < fim)
+		p++;
+}
+
+/**
+ * A line of a xxx_a.txt file: id;latitude;longitude (degrees);longitude;latitude (radians).
+ */
+struct NodeRecord {
+	BigAssInteger idNo;
+	long double latitudeGraus, longitudeGraus;
+	long double longitude, latitude;
+};
+
+/**
+ * A line of a xxx_c.txt file: the edge of the street idAresta from idNo1 to idNo2.
+ */
+struct EdgeRecord {
+	BigAssInteger idAresta;
+	BigAssInteger idNo1, idNo2;
+};
+
+inline bool parseNodeLine(const char *p, const char *fim, NodeRecord &reg) {
+	if (p == fim)
+		return false;
+	reg.idNo = parseUnsigned(p, fim);
+	skipField(p, fim);
+	reg.latitudeGraus = parseDecimal(p, fim);
+	skipField(p, fim);
+	reg.longitudeGraus = parseDecimal(p, fim);
+	skipField(p, fim);
+	reg.longitude = parseDecimal(p, fim);
+	skipField(p, fim);
+	reg.latitude = parseDecimal(p, fim);
+	return true;
+}
+
+/**
+ * @brief A line of a xxx_b.txt file: id;street name;True/False (two ways or not). The flag is the last
+ * field, since a few names have a ';' in them.
+ */
+inline bool parseStreetLine(const char *p, const char *fim, Aresta &reg) {
+	if (p == fim)
+		return false;
+	reg.idAresta = parseUnsigned(p, fim);
+	skipField(p, fim);
+	while (p < fim && (*p == ' ' || *p == '\t'))
+		p++;
+	const char *nome = p;
+	while (p < fim && *p != ';')
+		p++;
+	reg.rua = p == nome ? string("unnamed") : string(nome, p);
+	const char *flag = fim;
+	while (flag > p && flag[-1] != ';')
+		flag--;
+	while (flag < fim && (*flag == ' ' || *flag == '\t'))
+		flag++;
+	reg.dois_sentidos = fim - flag >= 4 && strncmp(flag, "True", 4) == 0;
+	reg.origem = NoInfo(0, 0, 0);
+	reg.destino = NoInfo(0, 0, 0);
+	reg.distancia = 0;
+	return true;
+}
+
+inline bool parseEdgeLine(const char *p, const char *fim, EdgeRecord &reg) {
+	if (p == fim)
+		return false;
+	reg.idAresta = parseUnsigned(p, fim);
+	skipField(p, fim);
+	reg.idNo1 = parseUnsigned(p, fim);
+	skipField(p, fim);
+	reg.idNo2 = parseUnsigned(p, fim);
+	return true;
+}
+
+/**
+ * @brief Parses the lines of dados[inicio, fim) into partes, one record per non-empty line.
+ */
+template<class R, class F>
+void parseLines(const char *dados, size_t inicio, size_t fim, F parseLinha,
+		vector<R> &partes) {
+	const char *p = dados + inicio;
+	const char *final = dados + fim;
+	R reg;
+	while (p < final) {
+		const char *eol = static_cast<const char *>(memchr(p, '\n', final - p));
+		if (eol == NULL)
+			eol = final;
+		const char *fimLinha = eol;
+		if (fimLinha > p && fimLinha[-1] == '\r')
+			fimLinha--;
+		if (parseLinha(p, fimLinha, reg))
+			partes.push_back(reg);
+		p = eol + 1;
+	}
+}
+
+/**
+ * @brief Parses a whole map file on the threads of pool.
+ * The file is split into blocks that end at a newline, each block is parsed by one task into its own
+ * vector, and the vectors are joined in the order of the blocks, so the records come out in the order
+ * of the lines of the file, as with a sequential read.
+ * @param parseLinha bool(const char *inicio, const char *fim, R &reg), false for lines with no record
+ * @param res output, the records
+ */
+template<class R, class F>
+void parseFileParallel(const MappedFile &ficheiro, F parseLinha,
+		ThreadPool &pool, vector<R> &res) {
+	const char *dados = ficheiro.data();
+	size_t tamanho = ficheiro.size();
+	res.clear();
+	if (tamanho == 0)
+		return;
+
+	size_t numBlocos = pool.size() == 1 ? 1 : pool.size() * PARSER_TAREFAS_POR_THREAD;
+	if (numBlocos > tamanho / PARSER_MINIMO_BLOCO + 1)
+		numBlocos = tamanho / PARSER_MINIMO_BLOCO + 1;
+	//cada bloco acaba depois de um '\n', para nenhuma linha ficar dividida
+	vector<size_t> limites(1, 0);
+	for (size_t b = 1; b < numBlocos; b++) {
+		size_t pos = tamanho * b / numBlocos;
+		if (pos < limites.back())
+			continue;
+		const char *eol = static_cast<const char *>(memchr(dados + pos, '\n',
+				tamanho - pos));
+		if (eol == NULL)
+			break;
+		pos = eol - dados + 1;
+		if (pos < tamanho)
+			limites.push_back(pos);
+	}
+	limites.push_back(tamanho);
+
+	if (limites.size() == 2) {
+		parseLines(dados, 0, tamanho, parseLinha, res);
+		return;
+	}
+	vector<vector<R> > partes(limites.size() - 1);
+	for (unsigned int b = 0; b + 1 < limites.size(); b++)
+		pool.submit([&, b](unsigned int) {
+			parseLines(dados, limites[b], limites[b + 1], parseLinha, partes[b]);
+		});
+	pool.wait();
+
+	size_t total = 0;
+	for (unsigned int b = 0; b < partes.size(); b++)
+		total += partes[b].size();
+	res.reserve(total);
+	for (unsigned int b = 0; b < partes.size(); b++)
+		res.insert(res.end(), partes[b].begin(), partes[b].end());
+}
+
+/**
+ * Street information of a map, kept for the snapshots (see MapSnapshot.h): the streets of xxx_b.txt in
+ * the order of the file, and the street of each edge of the graph, by edge id.
+ */
+struct MapStreets {
+	vector<Aresta> ruas;
+	vector<BigAssInteger> ruaDaAresta; //id da rua de cada id de aresta do grafo
+};
+
+/**
+ * Sizes and times of a map load: bytes and parsing time of each file (0 = xxx_a.txt, 1 = xxx_b.txt,
+ * 2 = xxx_c.txt), the time spent adding the records to the graph and the repeated nodes and edges
+ * dropped.
+ */
+struct LoadStats {
+	size_t bytes[3];
+	double parseSeconds[3];
+	double graphSeconds;
+	unsigned int repeatedNodes;
+	unsigned int duplicateEdges;
+	LoadStats() :
+			graphSeconds(0), repeatedNodes(0), duplicateEdges(0) {
+		for (unsigned int i = 0; i < 3; i++) {
+			bytes[i] = 0;
+			parseSeconds[i] = 0;
+		}
+	}
+};
+
+#endif /* SRC_MAPPARSER_H_ */
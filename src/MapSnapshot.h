@@ -0,0 +1,396 @@
+/*
+ * MapSnapshot.h
+ */
+#ifndef SRC_MAPSNAPSHOT_H_
+#define SRC_MAPSNAPSHOT_H_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <stdexcept>
+#include <unordered_map>
+#include <sys/stat.h>
+#include "NoInfo.h"
+#include "Graph.h"
+#include "MapParser.h"
+#include "NodeIdMap.h"
+
+using namespace std;
+
+#define SNAPSHOT_MAGIC "GRAFOSNP" //8 bytes no inicio do ficheiro
+#define SNAPSHOT_VERSAO 3 //incrementar a cada mudanca do formato
+#define SNAPSHOT_ORDEM 0x01020304 //deteta ficheiros escritos com outra ordem de bytes
+#define SNAPSHOT_ALINHAMENTO 16 //cada secao comeca num multiplo, para ser lida diretamente do mmap
+#define SNAPSHOT_SEM_RUA 0xFFFFFFFFu //aresta sem rua no xxx_b.txt
+
+/** @file */
+
+/**
+ * Header of a snapshot file. The data that follows is a fixed sequence of arrays whose sizes depend
+ * only on the counts in the header (see SnapshotLayout), each aligned to SNAPSHOT_ALINHAMENTO bytes:
+ *  - vertices: id in the map files, longitude, latitude (radians, long double) and layer (the dense
+ *    id of each vertex is its position, see NodeIdMap);
+ *  - CSR adjacency: numVertices + 1 offsets, then target, weight (long double), edge id and street of
+ *    each edge;
+ *  - streets: id, two ways flag and the offsets of the names in a block of characters;
+ *  - the filename radical of the map.
+ * Numbers are in the byte order and sizes of the machine that wrote the file; files from another
+ * machine, or with another version of the format, are refused. So are the snapshots of another map,
+ * or of other versions of its text files (by their size and modification time, see SnapshotSource).
+ */
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t versao;
+	uint32_t ordemBytes;
+	uint32_t tamanhoLongDouble;
+	uint32_t numVertices;
+	uint32_t numArestas;
+	uint32_t numRuas;
+	uint64_t bytesNomes;
+	uint64_t bytesDados; //depois do cabecalho
+	uint64_t checksum; //dos bytesDados
+	uint64_t bytesRadical;
+	uint64_t bytesFonte[3]; //dos xxx_a.txt, xxx_b.txt e xxx_c.txt de que foi feito
+	int64_t mtimeFonte[3]; //segundos
+	uint64_t reservado;
+};
+
+/**
+ * The text files of a map as they are now: the snapshot of the map is only valid while they stay the
+ * same size and have the same modification time as when it was written.
+ */
+struct SnapshotSource {
+	uint64_t bytes[3];
+	int64_t mtime[3];
+
+	/**
+	 * @throws runtime_error if one of the files doesn't exist
+	 */
+	explicit SnapshotSource(const string &radical) {
+		const char *tipos[] = { "_a.txt", "_b.txt", "_c.txt" };
+		for (unsigned int f = 0; f < 3; f++) {
+			struct stat info;
+			string nome = radical + tipos[f];
+			if (stat(nome.c_str(), &info) != 0)
+				throw runtime_error("Unable to open file " + nome);
+			bytes[f] = info.st_size;
+			mtime[f] = info.st_mtime;
+		}
+	}
+	bool matches(const SnapshotHeader &h) const {
+		for (unsigned int f = 0; f < 3; f++)
+			if (bytes[f] != h.bytesFonte[f] || mtime[f] != h.mtimeFonte[f])
+				return false;
+		return true;
+	}
+};
+
+/**
+ * Position of each array of a snapshot, in bytes from the end of the header.
+ */
+struct SnapshotLayout {
+	size_t ids, longitudes, latitudes, layers;
+	size_t offsets, targets, weights, edgeIds, ruasArestas;
+	size_t ruaIds, ruaDoisSentidos, nomesOffsets, nomes;
+	size_t radical;
+	size_t total;
+
+	explicit SnapshotLayout(const SnapshotHeader &h) {
+		size_t n = h.numVertices, m = h.numArestas, r = h.numRuas;
+		total = 0;
+		ids = section(n * sizeof(uint64_t));
+		longitudes = section(n * sizeof(long double));
+		latitudes = section(n * sizeof(long double));
+		layers = section(n);
+		offsets = section((n + 1) * sizeof(uint32_t));
+		targets = section(m * sizeof(uint32_t));
+		weights = section(m * sizeof(long double));
+		edgeIds = section(m * sizeof(uint64_t));
+		ruasArestas = section(m * sizeof(uint32_t));
+		ruaIds = section(r * sizeof(uint64_t));
+		ruaDoisSentidos = section(r);
+		nomesOffsets = section((r + 1) * sizeof(uint32_t));
+		nomes = section(h.bytesNomes);
+		radical = section(h.bytesRadical);
+	}
+private:
+	size_t section(size_t bytes) {
+		total = (total + SNAPSHOT_ALINHAMENTO - 1) / SNAPSHOT_ALINHAMENTO
+				* SNAPSHOT_ALINHAMENTO;
+		size_t inicio = total;
+		total += bytes;
+		return inicio;
+	}
+};
+
+/**
+ * @brief 64-bit FNV-1a over the words of the data (and then its last bytes), to detect truncated or
+ * corrupted snapshots.
+ */
+inline uint64_t snapshotChecksum(const char *dados, size_t tamanho) {
+	uint64_t h = 14695981039346656037ULL;
+	size_t palavras = tamanho / sizeof(uint64_t);
+	for (size_t i = 0; i < palavras; i++) {
+		uint64_t w;
+		memcpy(&w, dados + i * sizeof(uint64_t), sizeof(w));
+		h = (h ^ w) * 1099511628211ULL;
+	}
+	for (size_t i = palavras * sizeof(uint64_t); i < tamanho; i++)
+		h = (h ^ (unsigned char) dados[i]) * 1099511628211ULL;
+	return h;
+}
+
+/**
+ * @brief Writes a snapshot of a map graph, as built by abrirFicheiroXY (before any lines are added).
+ * @param radical the filename radical of the text files the graph was read from
+ * @param ruas the streets of the map, from abrirFicheiroXY
+ * @param ids the node ids of the map, from abrirFicheiroXY
+ * @throws runtime_error if the file can't be written, the text files of the map can't be found, or the
+ * dense ids of the vertices aren't their positions in the graph
+ */
+inline void writeSnapshot(const string &nome, const string &radical,
+		const Graph<NoInfo> &grafo, const MapStreets &ruas,
+		const NodeIdMap &ids) {
+	SnapshotSource fonte(radical);
+	ArrayView<Vertex<NoInfo> *> vertices = grafo.getVertexSet();
+	unordered_map<BigAssInteger, unsigned int> indiceRua;
+	SnapshotHeader h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+	h.versao = SNAPSHOT_VERSAO;
+	h.ordemBytes = SNAPSHOT_ORDEM;
+	h.tamanhoLongDouble = sizeof(long double);
+	h.numVertices = vertices.size();
+	for (unsigned int v = 0; v < vertices.size(); v++)
+		h.numArestas += vertices[v]->getEdges().size();
+	h.numRuas = ruas.ruas.size();
+	for (unsigned int r = 0; r < ruas.ruas.size(); r++) {
+		indiceRua[ruas.ruas[r].idAresta] = r;
+		h.bytesNomes += ruas.ruas[r].rua.size();
+	}
+	h.bytesRadical = radical.size();
+	for (unsigned int f = 0; f < 3; f++) {
+		h.bytesFonte[f] = fonte.bytes[f];
+		h.mtimeFonte[f] = fonte.mtime[f];
+	}
+	SnapshotLayout pos(h);
+	h.bytesDados = pos.total;
+
+	//buffer a zeros, para os bytes de enchimento (dos long double) serem sempre iguais
+	vector<char> buffer(pos.total + 1, 0);
+	char *d = &buffer[0];
+	uint32_t e = 0;
+	for (unsigned int v = 0; v < vertices.size(); v++) {
+		const NoInfo &info = vertices[v]->getInfo();
+		if (info.idNo != v || info.idNo >= ids.size())
+			throw runtime_error("Unable to write file " + nome
+					+ ", the vertices aren't in the order of their dense ids");
+		((uint64_t *) (d + pos.ids))[v] = ids.getOriginalId(info.idNo);
+		((long double *) (d + pos.longitudes))[v] = info.longitude;
+		((long double *) (d + pos.latitudes))[v] = info.latitude;
+		d[pos.layers + v] = info.layer;
+		((uint32_t *) (d + pos.offsets))[v] = e;
+		ArrayView<Edge<NoInfo> > arestas = vertices[v]->getEdges();
+		for (unsigned int i = 0; i < arestas.size(); i++, e++) {
+			((uint32_t *) (d + pos.targets))[e] = arestas[i].getDest()->getIndex();
+			((long double *) (d + pos.weights))[e] = arestas[i].getWeight();
+			((uint64_t *) (d + pos.edgeIds))[e] = arestas[i].id;
+			uint32_t rua = SNAPSHOT_SEM_RUA;
+			if (arestas[i].id < ruas.ruaDaAresta.size()) {
+				unordered_map<BigAssInteger, unsigned int>::const_iterator it =
+						indiceRua.find(ruas.ruaDaAresta[arestas[i].id]);
+				if (it != indiceRua.end())
+					rua = it->second;
+			}
+			((uint32_t *) (d + pos.ruasArestas))[e] = rua;
+		}
+	}
+	((uint32_t *) (d + pos.offsets))[vertices.size()] = e;
+
+	uint32_t inicioNome = 0;
+	for (unsigned int r = 0; r < ruas.ruas.size(); r++) {
+		((uint64_t *) (d + pos.ruaIds))[r] = ruas.ruas[r].idAresta;
+		d[pos.ruaDoisSentidos + r] = ruas.ruas[r].dois_sentidos;
+		((uint32_t *) (d + pos.nomesOffsets))[r] = inicioNome;
+		memcpy(d + pos.nomes + inicioNome, ruas.ruas[r].rua.data(),
+				ruas.ruas[r].rua.size());
+		inicioNome += ruas.ruas[r].rua.size();
+	}
+	((uint32_t *) (d + pos.nomesOffsets))[ruas.ruas.size()] = inicioNome;
+	memcpy(d + pos.radical, radical.data(), radical.size());
+	h.checksum = snapshotChecksum(d, pos.total);
+
+	FILE *f = fopen(nome.c_str(), "wb");
+	if (f == NULL)
+		throw runtime_error("Unable to write file " + nome);
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+			&& fwrite(d, 1, pos.total, f) == pos.total;
+	if (fclose(f) != 0 || !ok)
+		throw runtime_error("Unable to write file " + nome);
+}
+
+/**
+ * A map graph read from a snapshot file (see writeSnapshot). The file is mapped into memory and the
+ * arrays are used where they are, with no parsing; toGraph() builds the Graph that the rest of the
+ * program uses.
+ */
+class GraphSnapshot {
+	MappedFile ficheiro;
+	SnapshotHeader h;
+	const uint64_t *ids;
+	const long double *longitudes, *latitudes;
+	const char *layers;
+	const uint32_t *offsets, *targets;
+	const long double *weights;
+	const uint64_t *edgeIds;
+	const uint32_t *ruasArestas;
+	const uint64_t *ruaIds;
+	const char *ruaDoisSentidos;
+	const uint32_t *nomesOffsets;
+	const char *nomes;
+public:
+	GraphSnapshot(const string &nome, const string &radical);
+
+	unsigned int getNumVertex() const {
+		return h.numVertices;
+	}
+	unsigned int getNumEdges() const {
+		return h.numArestas;
+	}
+	size_t getFileBytes() const {
+		return ficheiro.size();
+	}
+	unsigned int getNumStreets() const {
+		return h.numRuas;
+	}
+	NoInfo getInfo(unsigned int v) const {
+		return NoInfo(v, longitudes[v], latitudes[v], layers[v]);
+	}
+	/**
+	 * @return the id of vertex v in the map files
+	 */
+	BigAssInteger getOriginalId(unsigned int v) const {
+		return ids[v];
+	}
+	unsigned int edgesBegin(unsigned int v) const {
+		return offsets[v];
+	}
+	unsigned int edgesEnd(unsigned int v) const {
+		return offsets[v + 1];
+	}
+	unsigned int getTarget(unsigned int e) const {
+		return targets[e];
+	}
+	long double getWeight(unsigned int e) const {
+		return weights[e];
+	}
+	unsigned long long getEdgeId(unsigned int e) const {
+		return edgeIds[e];
+	}
+	/**
+	 * @return the street of edge e (an index below getNumStreets()), or SNAPSHOT_SEM_RUA
+	 */
+	unsigned int getStreet(unsigned int e) const {
+		return ruasArestas[e];
+	}
+	BigAssInteger getStreetId(unsigned int r) const {
+		return ruaIds[r];
+	}
+	string getStreetName(unsigned int r) const {
+		return string(nomes + nomesOffsets[r], nomes + nomesOffsets[r + 1]);
+	}
+	bool isTwoWay(unsigned int r) const {
+		return ruaDoisSentidos[r] != 0;
+	}
+
+	void toGraph(Graph<NoInfo> &grafo, NodeIdMap *idsNos = NULL) const;
+};
+
+/**
+ * @brief Maps the snapshot and checks its header, size and checksum, and that it was written from the
+ * text files of radical as they are now.
+ * @param radical the filename radical of the text files of the map
+ * @throws runtime_error if the file can't be opened, isn't a valid snapshot for this machine or is
+ * the snapshot of another map or of other versions of its files
+ */
+inline GraphSnapshot::GraphSnapshot(const string &nome, const string &radical) :
+		ficheiro(nome) {
+	if (!ficheiro.isOpen())
+		throw runtime_error("Unable to open file " + nome);
+	if (ficheiro.size() < sizeof(h))
+		throw runtime_error(nome + " is not a graph snapshot");
+	memcpy(&h, ficheiro.data(), sizeof(h));
+	if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0)
+		throw runtime_error(nome + " is not a graph snapshot");
+	if (h.versao != SNAPSHOT_VERSAO || h.ordemBytes != SNAPSHOT_ORDEM
+			|| h.tamanhoLongDouble != sizeof(long double))
+		throw runtime_error(nome + " was written by another version or machine");
+	SnapshotLayout pos(h);
+	if (h.bytesDados != pos.total || ficheiro.size() - sizeof(h) != pos.total)
+		throw runtime_error(nome + " is truncated");
+	const char *d = ficheiro.data() + sizeof(h);
+	if (snapshotChecksum(d, pos.total) != h.checksum)
+		throw runtime_error(nome + " is corrupted (wrong checksum)");
+	string radicalGuardado(d + pos.radical, h.bytesRadical);
+	if (radicalGuardado != radical)
+		throw runtime_error(nome + " is the snapshot of " + radicalGuardado);
+	if (!SnapshotSource(radical).matches(h))
+		throw runtime_error(nome + " is older than the files of " + radical);
+
+	ids = (const uint64_t *) (d + pos.ids);
+	longitudes = (const long double *) (d + pos.longitudes);
+	latitudes = (const long double *) (d + pos.latitudes);
+	layers = d + pos.layers;
+	offsets = (const uint32_t *) (d + pos.offsets);
+	targets = (const uint32_t *) (d + pos.targets);
+	weights = (const long double *) (d + pos.weights);
+	edgeIds = (const uint64_t *) (d + pos.edgeIds);
+	ruasArestas = (const uint32_t *) (d + pos.ruasArestas);
+	ruaIds = (const uint64_t *) (d + pos.ruaIds);
+	ruaDoisSentidos = d + pos.ruaDoisSentidos;
+	nomesOffsets = (const uint32_t *) (d + pos.nomesOffsets);
+	nomes = d + pos.nomes;
+
+	//o checksum nao garante que os indices sao validos, so que o ficheiro nao mudou
+	bool valido = offsets[0] == 0 && offsets[h.numVertices] == h.numArestas
+			&& nomesOffsets[0] == 0 && nomesOffsets[h.numRuas] == h.bytesNomes;
+	for (unsigned int v = 0; valido && v < h.numVertices; v++)
+		valido = offsets[v] <= offsets[v + 1];
+	for (unsigned int e = 0; valido && e < h.numArestas; e++)
+		valido = targets[e] < h.numVertices
+				&& (ruasArestas[e] < h.numRuas || ruasArestas[e] == SNAPSHOT_SEM_RUA);
+	for (unsigned int r = 0; valido && r < h.numRuas; r++)
+		valido = nomesOffsets[r] <= nomesOffsets[r + 1];
+	if (!valido)
+		throw runtime_error(nome + " is corrupted (bad indices)");
+}
+
+/**
+ * @brief Adds the vertices and edges of the snapshot to grafo (empty), in the same order and with the
+ * same weights and ids as the graph that was saved.
+ * @param idsNos if not NULL (and empty), gets the node ids of the map files
+ * @throws runtime_error if the snapshot repeats a node id (before grafo is changed)
+ */
+inline void GraphSnapshot::toGraph(Graph<NoInfo> &grafo,
+		NodeIdMap *idsNos) const {
+	if (idsNos != NULL) {
+		idsNos->reserve(h.numVertices);
+		unsigned int idDenso;
+		for (unsigned int v = 0; v < h.numVertices; v++)
+			if (!idsNos->add(ids[v], idDenso) || idDenso != v)
+				throw runtime_error("The snapshot repeats a node id");
+	}
+	vector<NoInfo> infos(h.numVertices);
+	grafo.reserve(grafo.getNumVertex() + h.numVertices);
+	for (unsigned int v = 0; v < h.numVertices; v++) {
+		infos[v] = getInfo(v);
+		grafo.addVertex(infos[v]);
+	}
+	for (unsigned int v = 0; v < h.numVertices; v++)
+		for (unsigned int e = offsets[v]; e < offsets[v + 1]; e++)
+			grafo.addEdge(infos[v], infos[targets[e]], weights[e], edgeIds[e]);
+}
+
+#endif /* SRC_MAPSNAPSHOT_H_ */
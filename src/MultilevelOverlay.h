@@ -0,0 +1,408 @@
+/*
+ * MultilevelOverlay.h
+ */
+#ifndef SRC_MULTILEVELOVERLAY_H_
+#define SRC_MULTILEVELOVERLAY_H_
+
+#include <vector>
+#include <list>
+#include <limits>
+#include <algorithm>
+#include "FrozenGraph.h"
+#include "IndexedHeap.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+#define CRP_NIVEIS 3 //niveis da particao, acima dos vertices
+#define CRP_BITS_NIVEL 4 //cada celula junta 2^4 = 16 celulas do nivel de baixo
+#define CRP_TAMANHO_CELULA 128 //vertices, no maximo, de uma celula do nivel 1
+
+/** @file */
+
+/**
+ * Customizable route planning (CRP) over a routing snapshot.
+ *
+ * The vertices are split into cells, on CRP_NIVEIS nested levels: each cell of level l is the union
+ * of up to 2^CRP_BITS_NIVEL cells of level l-1. The boundary vertices of a cell are those with an edge
+ * to or from another cell of the same level, and the overlay keeps, for each cell, the clique of
+ * distances between its boundary vertices through the inside of the cell.
+ *
+ * Preprocessing is split in two: the partition and the boundaries depend only on the topology and are
+ * built once, by the constructor; the cliques depend on the weights and are filled by customize(), a
+ * level at a time, one cell per task. A change to the speeds or waiting times of the transports only
+ * needs a new customize(), with no new partition.
+ *
+ * A query is a Dijkstra that, at each vertex, uses the highest level whose cell contains neither the
+ * origin nor the destination: it goes over that cell through its clique and only looks at the original
+ * edges near both ends of the route.
+ */
+template<class T>
+class MultilevelOverlay {
+	const FrozenGraph<T> * grafo;
+	vector<unsigned int> folha; //celula do nivel 1 de cada vertice
+	vector<float> pesos; //pesos das arestas da ultima customizacao
+
+	struct Nivel {
+		//fronteira de cada celula c: vertices em [fronteiraOffsets[c], fronteiraOffsets[c+1])
+		vector<unsigned int> fronteiraOffsets;
+		vector<unsigned int> fronteira;
+		vector<unsigned int> posicao; //posicao de cada vertice na fronteira da sua celula (NO_VERTEX se nao e fronteira)
+		//clique de cada celula c: matriz k x k, por linhas, a partir de cliqueOffsets[c]
+		vector<unsigned int> cliqueOffsets;
+		vector<float> clique;
+	};
+	Nivel niveis[CRP_NIVEIS]; //niveis[l-1] e o nivel l
+
+	void bisect(vector<unsigned int> &ids, unsigned int inicio, unsigned int fim,
+			unsigned int profundidade, unsigned int prefixo);
+	void relax(unsigned int nivel, unsigned int v, float dv,
+			SearchWorkspace<float> &ws, unsigned int nivelCelula,
+			unsigned int celula) const;
+	void customizeCell(unsigned int nivel, unsigned int c,
+			SearchWorkspace<float> &ws);
+	unsigned int queryLevel(unsigned int s, unsigned int t, unsigned int v) const;
+	void unpack(unsigned int nivel, unsigned int a, unsigned int b,
+			SearchWorkspace<float> &ws, list<unsigned int> &res) const;
+public:
+	static const unsigned int NO_VERTEX = UINT_MAX;
+
+	MultilevelOverlay(const FrozenGraph<T> &grafo);
+
+	template<class W>
+	void customize(const W &peso, ThreadPool &pool);
+
+	/**
+	 * @return the cell of v at level nivel (v itself at level 0)
+	 */
+	unsigned int getCell(unsigned int nivel, unsigned int v) const {
+		return nivel == 0 ? v : folha[v] >> (CRP_BITS_NIVEL * (nivel - 1));
+	}
+	unsigned int getNumCells(unsigned int nivel) const {
+		return niveis[nivel - 1].fronteiraOffsets.size() - 1;
+	}
+	unsigned int getNumBoundary(unsigned int nivel) const {
+		return niveis[nivel - 1].fronteira.size();
+	}
+	size_t getMemoryBytes() const;
+
+	float query(unsigned int s, unsigned int t, SearchWorkspace<float> &ws,
+			bool usarOverlay = true) const;
+	vector<T> getOverlayPath(const T &origin, const T &dest,
+			SearchWorkspace<float> &ws, SearchWorkspace<float> &local) const;
+};
+
+template<class T>
+const unsigned int MultilevelOverlay<T>::NO_VERTEX;
+
+/**
+ * @brief Recursive coordinate bisection: splits ids[inicio, fim) at the median of its widest
+ * coordinate, profundidade times, and numbers the resulting cells of level 1 from prefixo.
+ * Vertices that share a stop (one per layer) have the same coordinates, so they tend to stay in the
+ * same cell, with the transfers between them inside it.
+ */
+template<class T>
+void MultilevelOverlay<T>::bisect(vector<unsigned int> &ids,
+		unsigned int inicio, unsigned int fim, unsigned int profundidade,
+		unsigned int prefixo) {
+	if (profundidade == 0) {
+		for (unsigned int i = inicio; i < fim; i++)
+			folha[ids[i]] = prefixo;
+		return;
+	}
+	if (fim - inicio > 1) {
+		long double minLong = grafo->getInfo(ids[inicio]).longitude, maxLong =
+				minLong;
+		long double minLat = grafo->getInfo(ids[inicio]).latitude, maxLat =
+				minLat;
+		for (unsigned int i = inicio + 1; i < fim; i++) {
+			const T &info = grafo->getInfo(ids[i]);
+			if (info.longitude < minLong)
+				minLong = info.longitude;
+			if (info.longitude > maxLong)
+				maxLong = info.longitude;
+			if (info.latitude < minLat)
+				minLat = info.latitude;
+			if (info.latitude > maxLat)
+				maxLat = info.latitude;
+		}
+		const FrozenGraph<T> &g = *grafo;
+		if (maxLong - minLong > maxLat - minLat)
+			nth_element(ids.begin() + inicio, ids.begin() + (inicio + fim) / 2,
+					ids.begin() + fim, [&g](unsigned int a, unsigned int b) {
+						return g.getInfo(a).longitude < g.getInfo(b).longitude;
+					});
+		else
+			nth_element(ids.begin() + inicio, ids.begin() + (inicio + fim) / 2,
+					ids.begin() + fim, [&g](unsigned int a, unsigned int b) {
+						return g.getInfo(a).latitude < g.getInfo(b).latitude;
+					});
+	}
+	unsigned int meio = (inicio + fim) / 2;
+	bisect(ids, inicio, meio, profundidade - 1, prefixo << 1);
+	bisect(ids, meio, fim, profundidade - 1, (prefixo << 1) | 1);
+}
+
+/**
+ * @brief Builds the partition and the boundary of every cell (the topology dependent part).
+ * The cliques stay at infinity until the first customize().
+ * @param grafo the routing snapshot; it must outlive the overlay
+ */
+template<class T>
+MultilevelOverlay<T>::MultilevelOverlay(const FrozenGraph<T> &grafo) :
+		grafo(&grafo) {
+	unsigned int n = grafo.getNumVertex();
+	unsigned int profundidade = 0;
+	while (((size_t) CRP_TAMANHO_CELULA << profundidade) < n)
+		profundidade++;
+	vector<unsigned int> ids(n);
+	for (unsigned int v = 0; v < n; v++)
+		ids[v] = v;
+	folha.assign(n, 0);
+	bisect(ids, 0, n, profundidade, 0);
+	pesos.assign(grafo.getNumEdges(), numeric_limits<float>::infinity());
+
+	for (unsigned int l = 1; l <= CRP_NIVEIS; l++) {
+		Nivel &nivel = niveis[l - 1];
+		unsigned int deslocamento = CRP_BITS_NIVEL * (l - 1);
+		unsigned int celulas =
+				deslocamento >= profundidade ?
+						1 : 1u << (profundidade - deslocamento);
+
+		vector<bool> eFronteira(n, false);
+		for (unsigned int v = 0; v < n; v++)
+			for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++)
+				if (getCell(l, grafo.getTarget(e)) != getCell(l, v)) {
+					eFronteira[v] = true;
+					eFronteira[grafo.getTarget(e)] = true;
+				}
+
+		//counting sort dos vertices de fronteira pela sua celula
+		nivel.fronteiraOffsets.assign(celulas + 1, 0);
+		for (unsigned int v = 0; v < n; v++)
+			if (eFronteira[v])
+				nivel.fronteiraOffsets[getCell(l, v) + 1]++;
+		for (unsigned int c = 0; c < celulas; c++)
+			nivel.fronteiraOffsets[c + 1] += nivel.fronteiraOffsets[c];
+		nivel.fronteira.resize(nivel.fronteiraOffsets[celulas]);
+		nivel.posicao.assign(n, NO_VERTEX);
+		vector<unsigned int> proxima(nivel.fronteiraOffsets.begin(),
+				nivel.fronteiraOffsets.end() - 1);
+		for (unsigned int v = 0; v < n; v++)
+			if (eFronteira[v]) {
+				unsigned int c = getCell(l, v);
+				nivel.posicao[v] = proxima[c] - nivel.fronteiraOffsets[c];
+				nivel.fronteira[proxima[c]++] = v;
+			}
+
+		nivel.cliqueOffsets.assign(celulas + 1, 0);
+		for (unsigned int c = 0; c < celulas; c++) {
+			unsigned int k = nivel.fronteiraOffsets[c + 1]
+					- nivel.fronteiraOffsets[c];
+			nivel.cliqueOffsets[c + 1] = nivel.cliqueOffsets[c] + k * k;
+		}
+		nivel.clique.assign(nivel.cliqueOffsets[celulas],
+				numeric_limits<float>::infinity());
+	}
+}
+
+/**
+ * @brief Relaxes the arcs of v at level nivel: the clique of its cell (if nivel > 0) and the original
+ * edges that leave that cell (all of them, at level 0).
+ * @param nivelCelula, celula only the arcs that stay inside this cell are used (celula = NO_VERTEX for all)
+ */
+template<class T>
+void MultilevelOverlay<T>::relax(unsigned int nivel, unsigned int v, float dv,
+		SearchWorkspace<float> &ws, unsigned int nivelCelula,
+		unsigned int celula) const {
+	IndexedHeap<float> &q = ws.getQueue();
+	unsigned int minha = getCell(nivel, v);
+	if (nivel > 0) {
+		const Nivel &n = niveis[nivel - 1];
+		unsigned int p = n.posicao[v];
+		unsigned int inicio = n.fronteiraOffsets[minha];
+		unsigned int k = n.fronteiraOffsets[minha + 1] - inicio;
+		const float *linha = &n.clique[n.cliqueOffsets[minha] + p * k];
+		for (unsigned int j = 0; j < k; j++) {
+			unsigned int w = n.fronteira[inicio + j];
+			float nova = dv + linha[j];
+			if (nova < ws.getDist(w)) {
+				ws.setDist(w, nova, v);
+				q.insertOrDecrease(w, nova);
+			}
+		}
+	}
+	for (unsigned int e = grafo->edgesBegin(v); e < grafo->edgesEnd(v); e++) {
+		unsigned int w = grafo->getTarget(e);
+		if (getCell(nivel, w) == minha
+				|| (celula != NO_VERTEX && getCell(nivelCelula, w) != celula))
+			continue;
+		float nova = dv + pesos[e];
+		if (nova < ws.getDist(w)) {
+			ws.setDist(w, nova, v);
+			q.insertOrDecrease(w, nova);
+		}
+	}
+}
+
+/**
+ * @brief Fills the clique of cell c of level nivel: a Dijkstra from each of its boundary vertices over
+ * the level below (original edges for level 1), without leaving the cell.
+ */
+template<class T>
+void MultilevelOverlay<T>::customizeCell(unsigned int nivel, unsigned int c,
+		SearchWorkspace<float> &ws) {
+	Nivel &n = niveis[nivel - 1];
+	unsigned int inicio = n.fronteiraOffsets[c];
+	unsigned int k = n.fronteiraOffsets[c + 1] - inicio;
+	float *matriz = &n.clique[n.cliqueOffsets[c]];
+	for (unsigned int i = 0; i < k; i++) {
+		ws.beginQuery(grafo->getNumVertex());
+		IndexedHeap<float> &q = ws.getQueue();
+		ws.setDist(n.fronteira[inicio + i], 0, NO_VERTEX);
+		q.insert(n.fronteira[inicio + i], 0);
+		while (!q.empty()) {
+			unsigned int v = q.extractMin();
+			relax(nivel - 1, v, ws.getDist(v), ws, nivel, c);
+		}
+		for (unsigned int j = 0; j < k; j++)
+			matriz[i * k + j] = ws.getDist(n.fronteira[inicio + j]);
+	}
+}
+
+/**
+ * @brief Computes the edge weights and the cliques of every cell (the metric dependent part). Each
+ * level only depends on the one below, and its cells are independent, so they are customized in
+ * parallel.
+ * @param peso the weight of each edge of the snapshot: peso(e) for e in 0..getNumEdges()-1
+ * @param pool the threads that customize the cells
+ */
+template<class T>
+template<class W>
+void MultilevelOverlay<T>::customize(const W &peso, ThreadPool &pool) {
+	for (unsigned int e = 0; e < pesos.size(); e++)
+		pesos[e] = peso(e);
+
+	vector<SearchWorkspace<float> > ws(pool.size());
+	for (unsigned int l = 1; l <= CRP_NIVEIS; l++) {
+		for (unsigned int c = 0; c < getNumCells(l); c++) {
+			if (niveis[l - 1].fronteiraOffsets[c]
+					== niveis[l - 1].fronteiraOffsets[c + 1])
+				continue;
+			pool.submit([this, l, c, &ws](unsigned int worker) {
+				customizeCell(l, c, ws[worker]);
+			});
+		}
+		pool.wait();
+	}
+}
+
+/**
+ * @return the highest level at which the cell of v contains neither s nor t (0 if there is none)
+ */
+template<class T>
+unsigned int MultilevelOverlay<T>::queryLevel(unsigned int s, unsigned int t,
+		unsigned int v) const {
+	for (unsigned int l = CRP_NIVEIS; l > 0; l--)
+		if (getCell(l, v) != getCell(l, s) && getCell(l, v) != getCell(l, t))
+			return l;
+	return 0;
+}
+
+/**
+ * @brief Distance from s to t with the weights of the last customization.
+ * @param usarOverlay if false, a plain Dijkstra over the original edges (same weights), for comparison
+ * @return the distance (infinity if t is unreachable); the search tree is left in ws
+ */
+template<class T>
+float MultilevelOverlay<T>::query(unsigned int s, unsigned int t,
+		SearchWorkspace<float> &ws, bool usarOverlay) const {
+	ws.beginQuery(grafo->getNumVertex());
+	IndexedHeap<float> &q = ws.getQueue();
+	ws.setDist(s, 0, NO_VERTEX);
+	q.insert(s, 0);
+	while (!q.empty()) {
+		unsigned int v = q.extractMin();
+		ws.countSettled();
+		if (v == t)
+			break;
+		relax(usarOverlay ? queryLevel(s, t, v) : 0, v, ws.getDist(v), ws,
+				0, NO_VERTEX);
+	}
+	return ws.getDist(t);
+}
+
+/**
+ * @brief Appends to res the original path of the clique arc a->b of level nivel, without a: a Dijkstra
+ * from a that does not leave their cell.
+ */
+template<class T>
+void MultilevelOverlay<T>::unpack(unsigned int nivel, unsigned int a,
+		unsigned int b, SearchWorkspace<float> &ws,
+		list<unsigned int> &res) const {
+	ws.beginQuery(grafo->getNumVertex());
+	IndexedHeap<float> &q = ws.getQueue();
+	ws.setDist(a, 0, NO_VERTEX);
+	q.insert(a, 0);
+	while (!q.empty()) {
+		unsigned int v = q.extractMin();
+		if (v == b)
+			break;
+		relax(0, v, ws.getDist(v), ws, nivel, getCell(nivel, a));
+	}
+	list<unsigned int>::iterator fim = res.end();
+	for (unsigned int v = b; v != a; v = ws.getPath(v))
+		fim = res.insert(fim, v);
+}
+
+/**
+ * @brief Shortest path between two vertices, with the clique arcs unpacked into original edges.
+ * @param ws workspace of the overlay search
+ * @param local workspace of the searches that unpack the clique arcs
+ * @return the path, or an empty vector if there is none
+ */
+template<class T>
+vector<T> MultilevelOverlay<T>::getOverlayPath(const T &origin, const T &dest,
+		SearchWorkspace<float> &ws, SearchWorkspace<float> &local) const {
+	vector<T> res;
+	unsigned int s = grafo->getIndex(origin), t = grafo->getIndex(dest);
+	if (s == NO_VERTEX || t == NO_VERTEX
+			|| query(s, t, ws) == numeric_limits<float>::infinity())
+		return res;
+
+	list<unsigned int> overlay;
+	for (unsigned int v = t; v != NO_VERTEX; v = ws.getPath(v))
+		overlay.push_front(v);
+
+	list<unsigned int> caminho;
+	caminho.push_back(s);
+	list<unsigned int>::const_iterator it = overlay.begin();
+	list<unsigned int>::const_iterator anterior = it++;
+	for (; it != overlay.end(); anterior = it++) {
+		unsigned int nivel = queryLevel(s, t, *anterior);
+		if (nivel > 0 && getCell(nivel, *it) == getCell(nivel, *anterior))
+			unpack(nivel, *anterior, *it, local, caminho);
+		else
+			caminho.push_back(*it);
+	}
+
+	for (it = caminho.begin(); it != caminho.end(); it++)
+		res.push_back(grafo->getInfo(*it));
+	return res;
+}
+
+/**
+ * @return the bytes taken by the partition, the boundaries, the cliques and the edge weights
+ */
+template<class T>
+size_t MultilevelOverlay<T>::getMemoryBytes() const {
+	size_t res = (folha.size() + pesos.size()) * sizeof(unsigned int);
+	for (unsigned int l = 0; l < CRP_NIVEIS; l++)
+		res += (niveis[l].fronteiraOffsets.size() + niveis[l].fronteira.size()
+				+ niveis[l].posicao.size() + niveis[l].cliqueOffsets.size())
+				* sizeof(unsigned int) + niveis[l].clique.size() * sizeof(float);
+	return res;
+}
+
+#endif /* SRC_MULTILEVELOVERLAY_H_ */
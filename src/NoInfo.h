@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <functional>
 #include "Transporte.h"
 
 using namespace std;
@@ -27,7 +28,7 @@ public:
 	char layer;
 	long double longitude;
 	long double latitude;
-	BigAssInteger idNo;
+	unsigned int idNo; //id denso, ver NodeIdMap
 	string nome_paragem;
 	NoInfo() {
 		longitude = 0.0;
@@ -37,7 +38,7 @@ public:
 		nome_paragem = "";
 	}
 
-	NoInfo(BigAssInteger id, long double longe, long double lat) {
+	NoInfo(unsigned int id, long double longe, long double lat) {
 		this->idNo = id;
 		this->longitude = longe;
 		this->latitude = lat;
@@ -48,7 +49,7 @@ public:
 
 
 
-	NoInfo(BigAssInteger id, long double longe, long double lat, char lay) {
+	NoInfo(unsigned int id, long double longe, long double lat, char lay) {
 					this->idNo = id;
 					this->longitude = longe;
 					this->latitude = lat;
@@ -56,7 +57,7 @@ public:
 					this->nome_paragem = "";
 				}
 
-	NoInfo(BigAssInteger id, long double longe, long double lat, char lay,string nome_paragem) {
+	NoInfo(unsigned int id, long double longe, long double lat, char lay,string nome_paragem) {
 						this->idNo = id;
 						this->longitude = longe;
 						this->latitude = lat;
@@ -94,5 +95,18 @@ long double NoInfo::getLongitude() const {
 	return longitude;
 }
 
+namespace std {
+/**
+ * Hash used by the graph's vertex index. Consistent with operator==, so only the
+ * identification number and the layer are taken into account.
+ */
+template<>
+struct hash<NoInfo> {
+	size_t operator()(const NoInfo &n) const {
+		return hash<BigAssInteger>()((BigAssInteger) n.idNo * 37 + n.layer);
+	}
+};
+}
+
 
 #endif /* SRC_NOINFO_H_ */
@@ -0,0 +1,96 @@
+/*
+ * NodeIdMap.h
+ */
+#ifndef SRC_NODEIDMAP_H_
+#define SRC_NODEIDMAP_H_
+
+#include <vector>
+#include <unordered_map>
+#include <climits>
+#include <stdexcept>
+#include "NoInfo.h"
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Table between the ids of the nodes in the map files (OpenStreetMap ids, 64 bits) and the dense ids
+ * used by the graph: 0, 1, 2, ... in the order the nodes are added, which fit in 32 bits and are also
+ * the ids given to the GraphViewer.
+ * Every distinct id gets its own dense id, so no two nodes are ever merged (as they could be when the
+ * ids were cut to their last 8 digits); a node id that appears again is detected and counted, and
+ * keeps the dense id of its first appearance.
+ */
+class NodeIdMap {
+	unordered_map<BigAssInteger, unsigned int> densos;
+	vector<BigAssInteger> originais; //id do ficheiro de cada id denso
+	unsigned int repetidos;
+public:
+	static const unsigned int NO_ID = UINT_MAX;
+
+	NodeIdMap() :
+			repetidos(0) {
+	}
+
+	void reserve(unsigned int numNodes) {
+		densos.reserve(numNodes);
+		originais.reserve(numNodes);
+	}
+	bool add(BigAssInteger idOriginal, unsigned int &idDenso);
+
+	/**
+	 * @return the dense id of idOriginal, or NO_ID if it was never added
+	 */
+	unsigned int find(BigAssInteger idOriginal) const {
+		unordered_map<BigAssInteger, unsigned int>::const_iterator it =
+				densos.find(idOriginal);
+		return it == densos.end() ? NO_ID : it->second;
+	}
+	/**
+	 * @return the id in the map files of the dense id idDenso (which must be below size())
+	 */
+	BigAssInteger getOriginalId(unsigned int idDenso) const {
+		return originais[idDenso];
+	}
+	unsigned int size() const {
+		return originais.size();
+	}
+	/**
+	 * @return how many times add() was given an id it already had
+	 */
+	unsigned int getNumRepeated() const {
+		return repetidos;
+	}
+	void clear() {
+		densos.clear();
+		originais.clear();
+		repetidos = 0;
+	}
+};
+
+const unsigned int NodeIdMap::NO_ID;
+
+/**
+ * @brief Gives idOriginal the next dense id, unless it already has one.
+ * @param idDenso output, the dense id of idOriginal (new or not)
+ * @return false if idOriginal had already been added (a repeated node)
+ * @throws runtime_error if there are more nodes than dense ids
+ */
+inline bool NodeIdMap::add(BigAssInteger idOriginal, unsigned int &idDenso) {
+	pair<unordered_map<BigAssInteger, unsigned int>::iterator, bool> res =
+			densos.insert(make_pair(idOriginal, (unsigned int) originais.size()));
+	idDenso = res.first->second;
+	if (!res.second) {
+		repetidos++;
+		return false;
+	}
+	if (originais.size() == NO_ID) {
+		densos.erase(res.first);
+		throw runtime_error("Too many nodes for 32-bit ids");
+	}
+	originais.push_back(idOriginal);
+	return true;
+}
+
+#endif /* SRC_NODEIDMAP_H_ */
@@ -0,0 +1,110 @@
+/*
+ * PerfCounters.h
+ */
+#ifndef SRC_PERFCOUNTERS_H_
+#define SRC_PERFCOUNTERS_H_
+
+#include <cstdio>
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Counts the cache misses of the calling thread between start() and stop(), with the hardware
+ * counters of perf_event_open (user space only). Only on Linux, and only where the kernel gives
+ * access to the counters (not in most virtual machines); elsewhere isAvailable() is false and the
+ * count stays at 0.
+ */
+class CacheMissCounter {
+	int fd;
+	long long total;
+
+	CacheMissCounter(const CacheMissCounter &);
+	CacheMissCounter &operator=(const CacheMissCounter &);
+public:
+	CacheMissCounter();
+	~CacheMissCounter();
+
+	bool isAvailable() const {
+		return fd >= 0;
+	}
+	/**
+	 * @return the cache misses counted so far, over every start()..stop() interval
+	 */
+	long long getCount() const {
+		return total;
+	}
+	void start();
+	void stop();
+};
+
+inline CacheMissCounter::CacheMissCounter() :
+		fd(-1), total(0) {
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+}
+
+inline CacheMissCounter::~CacheMissCounter() {
+#ifdef __linux__
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+inline void CacheMissCounter::start() {
+#ifdef __linux__
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+}
+
+inline void CacheMissCounter::stop() {
+#ifdef __linux__
+	if (fd >= 0) {
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		long long contagem = 0;
+		if (read(fd, &contagem, sizeof(contagem)) == sizeof(contagem))
+			total += contagem;
+	}
+#endif
+}
+
+/**
+ * @return the resident set size of the process in bytes, from /proc/self/statm (only on Linux; 0
+ * elsewhere)
+ */
+inline size_t residentSetBytes() {
+	size_t paginas = 0;
+#ifdef __linux__
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f == NULL)
+		return 0;
+	unsigned long total, residentes;
+	if (fscanf(f, "%lu %lu", &total, &residentes) == 2)
+		paginas = residentes;
+	fclose(f);
+	return paginas * sysconf(_SC_PAGESIZE);
+#endif
+	return paginas;
+}
+
+#endif /* SRC_PERFCOUNTERS_H_ */
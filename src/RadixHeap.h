@@ -0,0 +1,85 @@
+/*
+ * RadixHeap.h
+ */
+#ifndef SRC_RADIXHEAP_H_
+#define SRC_RADIXHEAP_H_
+
+#include <vector>
+#include <utility>
+#include <limits.h>
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Monotone radix heap over unsigned int keys.
+ * Only works if keys are never below the last key extracted, which holds for Dijkstra with
+ * non-negative weights. Bucket i > 0 keeps the entries whose key first differs from the last extracted
+ * key at bit i-1, so each entry only moves to lower buckets, at most 32 times in all, and every
+ * operation is a few integer comparisons.
+ * There is no decrease-key: an element is inserted again with its new key, and the caller skips the
+ * old entries when they come out (their key no longer matches the element's distance).
+ */
+class RadixHeap {
+	vector<pair<unsigned int, unsigned int> > buckets[33]; //(chave, elemento)
+	unsigned int last;
+	unsigned int count;
+
+	static unsigned int bucketOf(unsigned int key, unsigned int last) {
+		return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+	}
+public:
+	RadixHeap() :
+			last(0), count(0) {
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+	unsigned int size() const {
+		return count;
+	}
+	void clear() {
+		for (unsigned int i = 0; i < 33; i++)
+			buckets[i].clear();
+		last = 0;
+		count = 0;
+	}
+
+	void insert(unsigned int elem, unsigned int key) {
+		buckets[bucketOf(key, last)].push_back(make_pair(key, elem));
+		count++;
+	}
+	unsigned int extractMin(unsigned int &key);
+};
+
+/**
+ * @brief Removes an entry with the smallest key.
+ * If bucket 0 is empty, the smallest key of the first non-empty bucket becomes the new last key and the
+ * entries of that bucket are spread over the buckets below it.
+ * @param key output, the key of the entry
+ * @return the element of the entry
+ */
+inline unsigned int RadixHeap::extractMin(unsigned int &key) {
+	if (buckets[0].empty()) {
+		unsigned int i = 1;
+		while (buckets[i].empty())
+			i++;
+		unsigned int menor = UINT_MAX;
+		for (unsigned int j = 0; j < buckets[i].size(); j++)
+			if (buckets[i][j].first < menor)
+				menor = buckets[i][j].first;
+		last = menor;
+		for (unsigned int j = 0; j < buckets[i].size(); j++)
+			buckets[bucketOf(buckets[i][j].first, last)].push_back(buckets[i][j]);
+		buckets[i].clear();
+	}
+	key = buckets[0].back().first;
+	unsigned int elem = buckets[0].back().second;
+	buckets[0].pop_back();
+	count--;
+	return elem;
+}
+
+#endif /* SRC_RADIXHEAP_H_ */
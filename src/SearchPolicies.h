@@ -0,0 +1,118 @@
+/*
+ * SearchPolicies.h
+ */
+#ifndef SRC_SEARCHPOLICIES_H_
+#define SRC_SEARCHPOLICIES_H_
+
+#include <cmath>
+#include "IndexedHeap.h"
+#include "RadixHeap.h"
+
+using namespace std;
+
+#define PONTO_FIXO_POR_HORA 3600000 //pesos inteiros do Graph em milissegundos
+
+/** @file */
+
+/*
+ * Compile-time policies of the searches of Graph<T, W>: the type of the weights and distances (W,
+ * through WeightTraits), the priority queue (Q of SearchWorkspace<W, Q>, through QueuePolicy) and the
+ * heuristic (any functor called with a vertex, see heuristicFunc in Graph.h and zeroHeuristic). Each
+ * combination is a separate instantiation of the search, with every call inlined.
+ */
+
+/**
+ * How a weight type keeps the weights, which are always given and read in hours. Floating point
+ * types keep them as they are (rounded to their precision).
+ */
+template<class W>
+struct WeightTraits {
+	static W fromHours(long double horas) {
+		return (W) horas;
+	}
+	/**
+	 * @brief An A* estimate (a lower bound, in hours) in W.
+	 */
+	static W fromEstimate(long double horas) {
+		return (W) horas;
+	}
+	static long double toHours(W peso) {
+		return peso;
+	}
+};
+
+/**
+ * Fixed point weights: integers in units of 1/PONTO_FIXO_POR_HORA hours (milliseconds), so a distance
+ * only overflows after 1193 hours. Each weight is rounded up and each estimate down, so a heuristic that
+ * is consistent in hours is still consistent in units (floor(a) <= ceil(w) + floor(b) whenever
+ * a <= w + b) and the keys of an A* never decrease, as a RadixHeap requires. The units are finer than
+ * the ones of FrozenGraph::quantize (which rounds to the nearest) so the rounding up of every edge adds
+ * little to a route.
+ */
+template<>
+struct WeightTraits<unsigned int> {
+	static unsigned int fromHours(long double horas) {
+		return (unsigned int) ceill(horas * PONTO_FIXO_POR_HORA);
+	}
+	static unsigned int fromEstimate(long double horas) {
+		return (unsigned int) floorl(horas * PONTO_FIXO_POR_HORA);
+	}
+	static long double toHours(unsigned int peso) {
+		return (long double) peso / PONTO_FIXO_POR_HORA;
+	}
+};
+
+/**
+ * The operations of a priority queue of vertices (by index) used by the searches. With DECREASE_KEY
+ * the queue keeps one entry per vertex and lowers its key; without it a vertex improved again is
+ * inserted again, and the search skips its older entries when they come out.
+ */
+template<class Q>
+struct QueuePolicy;
+
+/**
+ * Indexed D-ary heap: one entry per vertex, with decrease-key.
+ */
+template<class K, unsigned int D>
+struct QueuePolicy<IndexedHeap<K, D> > {
+	static const bool DECREASE_KEY = true;
+	static void resize(IndexedHeap<K, D> &q, unsigned int n) {
+		q.resize(n);
+	}
+	static void push(IndexedHeap<K, D> &q, unsigned int v, K chave) {
+		q.insertOrDecrease(v, chave);
+	}
+	static unsigned int pop(IndexedHeap<K, D> &q, K &chave) {
+		chave = q.minKey();
+		return q.extractMin();
+	}
+};
+
+/**
+ * Radix heap: unsigned int keys that never decrease (Dijkstra, or A* with a consistent heuristic), no
+ * decrease-key.
+ */
+template<>
+struct QueuePolicy<RadixHeap> {
+	static const bool DECREASE_KEY = false;
+	static void resize(RadixHeap &, unsigned int) {
+	}
+	static void push(RadixHeap &q, unsigned int v, unsigned int chave) {
+		q.insert(v, chave);
+	}
+	static unsigned int pop(RadixHeap &q, unsigned int &chave) {
+		return q.extractMin(chave);
+	}
+};
+
+/**
+ * Heuristic that always returns 0, for any vertex: A* with it is Dijkstra's algorithm.
+ */
+struct zeroHeuristic {
+	template<class V>
+	long double operator()(const V *) const {
+		return 0;
+	}
+};
+
+#endif /* SRC_SEARCHPOLICIES_H_ */
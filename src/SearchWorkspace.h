@@ -0,0 +1,122 @@
+/*
+ * SearchWorkspace.h
+ */
+#ifndef SRC_SEARCHWORKSPACE_H_
+#define SRC_SEARCHWORKSPACE_H_
+
+#include <vector>
+#include <limits>
+#include <limits.h>
+#include "IndexedHeap.h"
+#include "SearchPolicies.h"
+
+using namespace std;
+
+/** @file */
+
+/**
+ * State of one shortest path query (distances, predecessors and priority queue), kept out of the
+ * graph so the graph is only read during the search and several queries can run at the same time,
+ * each one with its own workspace (e.g. one per thread).
+ *
+ * A workspace is meant to be reused: beginQuery() only increments an epoch counter, and a vertex
+ * counts as "reset" (infinite distance, no predecessor) while its stamp is from an older epoch.
+ * Only the vertices touched by a query are ever written, so there is no O(V) reset between queries.
+ *
+ * W is the type of the distances and Q the priority queue, any type with a QueuePolicy.
+ */
+template<class W, class Q = IndexedHeap<W> >
+class SearchWorkspace {
+	vector<unsigned int> stamp;
+	vector<W> dist;
+	vector<unsigned int> path;
+	unsigned int epoch;
+	unsigned int settled;
+	Q queue;
+	vector<W> estimate; //so alocado na primeira estimativa (A*)
+public:
+	static const unsigned int NO_VERTEX = UINT_MAX;
+
+	SearchWorkspace() :
+			epoch(0), settled(0) {
+	}
+
+	static W infinity() {
+		return numeric_limits<W>::has_infinity ?
+				numeric_limits<W>::infinity() : (numeric_limits<W>::max)();
+	}
+
+	void beginQuery(unsigned int numVertex);
+
+	bool reached(unsigned int v) const {
+		return stamp[v] == epoch;
+	}
+	W getDist(unsigned int v) const {
+		return stamp[v] == epoch ? dist[v] : infinity();
+	}
+	unsigned int getPath(unsigned int v) const {
+		return stamp[v] == epoch ? path[v] : NO_VERTEX;
+	}
+	void setDist(unsigned int v, W d, unsigned int pred) {
+		stamp[v] = epoch;
+		dist[v] = d;
+		path[v] = pred;
+	}
+	Q& getQueue() {
+		return queue;
+	}
+
+	/**
+	 * @brief Counts one more vertex taken out of the queue (the search space of the query).
+	 */
+	void countSettled() {
+		settled++;
+	}
+	unsigned int getNumSettled() const {
+		return settled;
+	}
+
+	/**
+	 * @brief Keeps the A* estimate of v (a lower bound of its distance to the destination), for the
+	 * rest of the query. It shares the stamp of the distance, so it must be set when v is first reached
+	 * and is then valid while reached(v): the heuristic is computed once for each vertex the search
+	 * reaches, and never for the others.
+	 */
+	void setEstimate(unsigned int v, W e) {
+		if (estimate.size() != stamp.size())
+			estimate.resize(stamp.size());
+		estimate[v] = e;
+	}
+	W getEstimate(unsigned int v) const {
+		return estimate[v];
+	}
+	unsigned int size() const {
+		return stamp.size();
+	}
+};
+
+template<class W, class Q>
+const unsigned int SearchWorkspace<W, Q>::NO_VERTEX;
+
+/**
+ * @brief Starts a new query over a graph with numVertex vertices. All vertices become unreached.
+ */
+template<class W, class Q>
+void SearchWorkspace<W, Q>::beginQuery(unsigned int numVertex) {
+	if (stamp.size() != numVertex) {
+		stamp.assign(numVertex, 0);
+		dist.resize(numVertex);
+		path.resize(numVertex);
+		QueuePolicy<Q>::resize(queue, numVertex);
+		epoch = 0;
+	}
+	queue.clear();
+	settled = 0;
+	epoch++;
+	if (epoch == 0) { //deu a volta, os stamps antigos deixam de ser fiaveis
+		stamp.assign(numVertex, 0);
+		epoch = 1;
+	}
+}
+
+#endif /* SRC_SEARCHWORKSPACE_H_ */
@@ -0,0 +1,260 @@
+/*
+ * SpatialIndex.h
+ */
+#ifndef SRC_SPATIALINDEX_H_
+#define SRC_SPATIALINDEX_H_
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "FrozenGraph.h"
+#include "GeoDistance.h"
+
+using namespace std;
+
+#define KD_FOLHA 8 //pontos a partir dos quais um ramo ja nao e dividido, e percorrido todo
+
+/** @file */
+
+/**
+ * A vertex found by a SpatialIndex query, and its distance (great circle, in km) to the point.
+ */
+struct NearbyVertex {
+	unsigned int vertice;
+	double km;
+	bool operator<(const NearbyVertex &outro) const {
+		return km < outro.km;
+	}
+};
+
+/**
+ * Static k-d tree over the coordinates of the vertices of a routing snapshot, to find the vertices
+ * nearest to any point (nearest-k) or within some distance of it (radius), instead of computing the
+ * distance to every vertex.
+ * Each vertex is kept as the point of its latitude and longitude on the unit sphere (x, y, z): the
+ * straight line (chord) between two such points grows with the great circle distance, so the tree
+ * can work with plain euclidean distances, with no trouble at the poles or at longitude 180.
+ * There is a separate tree for each layer (' ' foot, 'A' bus, 'M' subway), so a query for one layer
+ * never visits the vertices of the others. Each tree is implicit: the points are ordered so that each
+ * range is split at its middle point, by the coordinate with the widest spread in it.
+ */
+template<class T>
+class SpatialIndex {
+	struct Ponto {
+		double c[3];
+		unsigned int vertice;
+	};
+	struct Arvore {
+		char layer;
+		vector<Ponto> pontos;
+		vector<unsigned char> eixos; //coordenada da divisao, na posicao do ponto do meio
+	};
+	vector<Arvore> arvores;
+
+	static double squaredChord(const double a[3], const double b[3]) {
+		double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	static void build(Arvore &a, unsigned int inicio, unsigned int fim);
+	static void nearest(const Arvore &a, unsigned int inicio, unsigned int fim,
+			const double q[3], unsigned int k, vector<pair<double, unsigned int> > &heap);
+	static void within(const Arvore &a, unsigned int inicio, unsigned int fim,
+			const double q[3], double corda2, vector<pair<double, unsigned int> > &res);
+	static vector<NearbyVertex> sorted(
+			vector<pair<double, unsigned int> > &encontrados);
+public:
+	explicit SpatialIndex(const FrozenGraph<T> &grafo);
+
+	vector<NearbyVertex> nearest(long double latitude, long double longitude,
+			unsigned int k, const string &layers = " ") const;
+	vector<NearbyVertex> withinRadius(long double latitude,
+			long double longitude, double km, const string &layers = " ") const;
+
+	/**
+	 * @return the number of vertices of layer in the index
+	 */
+	unsigned int size(char layer) const {
+		for (unsigned int i = 0; i < arvores.size(); i++)
+			if (arvores[i].layer == layer)
+				return arvores[i].pontos.size();
+		return 0;
+	}
+};
+
+/**
+ * @brief Builds the trees of all the layers of grafo, in O(n log n).
+ */
+template<class T>
+SpatialIndex<T>::SpatialIndex(const FrozenGraph<T> &grafo) {
+	for (unsigned int v = 0; v < grafo.getNumVertex(); v++) {
+		const T &info = grafo.getInfo(v);
+		unsigned int i = 0;
+		while (i < arvores.size() && arvores[i].layer != info.layer)
+			i++;
+		if (i == arvores.size()) {
+			arvores.push_back(Arvore());
+			arvores[i].layer = info.layer;
+		}
+		Ponto p;
+		unitVector(info.latitude, info.longitude, p.c);
+		p.vertice = v;
+		arvores[i].pontos.push_back(p);
+	}
+	for (unsigned int i = 0; i < arvores.size(); i++) {
+		arvores[i].eixos.resize(arvores[i].pontos.size(), 0);
+		build(arvores[i], 0, arvores[i].pontos.size());
+	}
+}
+
+template<class T>
+void SpatialIndex<T>::build(Arvore &a, unsigned int inicio, unsigned int fim) {
+	if (fim - inicio <= KD_FOLHA)
+		return;
+	double menor[3], maior[3];
+	for (unsigned int d = 0; d < 3; d++)
+		menor[d] = maior[d] = a.pontos[inicio].c[d];
+	for (unsigned int i = inicio + 1; i < fim; i++)
+		for (unsigned int d = 0; d < 3; d++) {
+			if (a.pontos[i].c[d] < menor[d])
+				menor[d] = a.pontos[i].c[d];
+			if (a.pontos[i].c[d] > maior[d])
+				maior[d] = a.pontos[i].c[d];
+		}
+	unsigned char eixo = 0;
+	for (unsigned int d = 1; d < 3; d++)
+		if (maior[d] - menor[d] > maior[eixo] - menor[eixo])
+			eixo = d;
+
+	unsigned int meio = inicio + (fim - inicio) / 2;
+	nth_element(a.pontos.begin() + inicio, a.pontos.begin() + meio,
+			a.pontos.begin() + fim, [eixo](const Ponto &p1, const Ponto &p2) {
+				return p1.c[eixo] < p2.c[eixo];
+			});
+	a.eixos[meio] = eixo;
+	build(a, inicio, meio);
+	build(a, meio + 1, fim);
+}
+
+/**
+ * @brief Adds the points of [inicio, fim) nearer to q than the k-th of heap (a max-heap of the k
+ * nearest so far) to heap, skipping the ranges that can't have any.
+ */
+template<class T>
+void SpatialIndex<T>::nearest(const Arvore &a, unsigned int inicio,
+		unsigned int fim, const double q[3], unsigned int k,
+		vector<pair<double, unsigned int> > &heap) {
+	if (fim - inicio <= KD_FOLHA) {
+		for (unsigned int i = inicio; i < fim; i++) {
+			double corda2 = squaredChord(q, a.pontos[i].c);
+			if (heap.size() < k) {
+				heap.push_back(make_pair(corda2, a.pontos[i].vertice));
+				push_heap(heap.begin(), heap.end());
+			} else if (corda2 < heap.front().first) {
+				pop_heap(heap.begin(), heap.end());
+				heap.back() = make_pair(corda2, a.pontos[i].vertice);
+				push_heap(heap.begin(), heap.end());
+			}
+		}
+		return;
+	}
+	unsigned int meio = inicio + (fim - inicio) / 2;
+	nearest(a, meio, meio + 1, q, k, heap);
+	double diferenca = q[a.eixos[meio]] - a.pontos[meio].c[a.eixos[meio]];
+	//primeiro o lado de q, depois o outro so se ainda puder ter pontos mais perto
+	if (diferenca < 0) {
+		nearest(a, inicio, meio, q, k, heap);
+		if (heap.size() < k || diferenca * diferenca < heap.front().first)
+			nearest(a, meio + 1, fim, q, k, heap);
+	} else {
+		nearest(a, meio + 1, fim, q, k, heap);
+		if (heap.size() < k || diferenca * diferenca < heap.front().first)
+			nearest(a, inicio, meio, q, k, heap);
+	}
+}
+
+/**
+ * @brief Adds the points of [inicio, fim) at a squared chord of at most corda2 from q to res.
+ */
+template<class T>
+void SpatialIndex<T>::within(const Arvore &a, unsigned int inicio,
+		unsigned int fim, const double q[3], double corda2,
+		vector<pair<double, unsigned int> > &res) {
+	if (fim - inicio <= KD_FOLHA) {
+		for (unsigned int i = inicio; i < fim; i++) {
+			double d = squaredChord(q, a.pontos[i].c);
+			if (d <= corda2)
+				res.push_back(make_pair(d, a.pontos[i].vertice));
+		}
+		return;
+	}
+	unsigned int meio = inicio + (fim - inicio) / 2;
+	within(a, meio, meio + 1, q, corda2, res);
+	double diferenca = q[a.eixos[meio]] - a.pontos[meio].c[a.eixos[meio]];
+	if (diferenca < 0 || diferenca * diferenca <= corda2)
+		within(a, inicio, meio, q, corda2, res);
+	if (diferenca >= 0 || diferenca * diferenca <= corda2)
+		within(a, meio + 1, fim, q, corda2, res);
+}
+
+template<class T>
+vector<NearbyVertex> SpatialIndex<T>::sorted(
+		vector<pair<double, unsigned int> > &encontrados) {
+	sort(encontrados.begin(), encontrados.end());
+	vector<NearbyVertex> res(encontrados.size());
+	for (unsigned int i = 0; i < encontrados.size(); i++) {
+		res[i].vertice = encontrados[i].second;
+		res[i].km = chordToKm(sqrt(encontrados[i].first));
+	}
+	return res;
+}
+
+/**
+ * @brief The k vertices nearest to a point, in the given layers.
+ * @param latitude latitude of the point, in radians (like the vertices)
+ * @param longitude longitude of the point, in radians
+ * @param layers the layers to search (e.g. " " foot only, "AM" bus or subway)
+ * @return up to k vertices, nearest first
+ */
+template<class T>
+vector<NearbyVertex> SpatialIndex<T>::nearest(long double latitude,
+		long double longitude, unsigned int k, const string &layers) const {
+	if (k == 0)
+		return vector<NearbyVertex>();
+	double q[3];
+	unitVector(latitude, longitude, q);
+	vector<pair<double, unsigned int> > heap;
+	heap.reserve(k);
+	//o mesmo heap para todas as layers, os k melhores de uma cortam a pesquisa nas outras
+	for (unsigned int i = 0; i < arvores.size(); i++)
+		if (layers.find(arvores[i].layer) != string::npos)
+			nearest(arvores[i], 0, arvores[i].pontos.size(), q, k, heap);
+	return sorted(heap);
+}
+
+/**
+ * @brief The vertices within km of a point (great circle distance), in the given layers.
+ * @param latitude latitude of the point, in radians (like the vertices)
+ * @param longitude longitude of the point, in radians
+ * @param layers the layers to search (e.g. " " foot only, "AM" bus or subway)
+ * @return the vertices found, nearest first
+ */
+template<class T>
+vector<NearbyVertex> SpatialIndex<T>::withinRadius(long double latitude,
+		long double longitude, double km, const string &layers) const {
+	if (km < 0)
+		return vector<NearbyVertex>();
+	double q[3];
+	unitVector(latitude, longitude, q);
+	vector<pair<double, unsigned int> > res;
+	//a corda de um arco de km: 2 sen(angulo / 2), ate ao lado oposto da esfera
+	double angulo = km / RAIO_TERRA_KM;
+	double corda = angulo >= M_PI ? 2 : 2 * sin(angulo / 2);
+	for (unsigned int i = 0; i < arvores.size(); i++)
+		if (layers.find(arvores[i].layer) != string::npos)
+			within(arvores[i], 0, arvores[i].pontos.size(), q, corda * corda, res);
+	return sorted(res);
+}
+
+#endif /* SRC_SPATIALINDEX_H_ */
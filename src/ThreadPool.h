@@ -0,0 +1,159 @@
+/*
+ * ThreadPool.h
+ */
+#ifndef SRC_THREADPOOL_H_
+#define SRC_THREADPOOL_H_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/** @file */
+
+/**
+ * Fixed size pool of worker threads with work stealing.
+ * Each worker has its own task deque: submitted tasks are spread over the deques, a worker takes
+ * tasks from the back of its own deque and, when it runs out, steals from the front of the others.
+ * Tasks receive the index of the worker running them (0..size()-1), so they can use per-thread
+ * state such as a SearchWorkspace without locking.
+ */
+class ThreadPool {
+public:
+	typedef function<void(unsigned int)> Task;
+
+	explicit ThreadPool(unsigned int numThreads);
+	~ThreadPool();
+
+	unsigned int size() const {
+		return threads.size();
+	}
+	void submit(const Task &task);
+	void wait();
+
+private:
+	struct TaskQueue {
+		mutex m;
+		deque<Task> tasks;
+	};
+
+	vector<thread> threads;
+	vector<TaskQueue *> queues;
+	mutex m;
+	condition_variable hasWork;
+	condition_variable allDone;
+	unsigned int queued;
+	unsigned int pending;
+	unsigned int nextQueue;
+	bool stopping;
+
+	bool takeTask(unsigned int worker, Task &task);
+	void workerLoop(unsigned int worker);
+
+	ThreadPool(const ThreadPool &);
+	ThreadPool &operator=(const ThreadPool &);
+};
+
+inline ThreadPool::ThreadPool(unsigned int numThreads) :
+		queued(0), pending(0), nextQueue(0), stopping(false) {
+	if (numThreads == 0)
+		numThreads = 1;
+	for (unsigned int i = 0; i < numThreads; i++)
+		queues.push_back(new TaskQueue());
+	for (unsigned int i = 0; i < numThreads; i++)
+		threads.push_back(thread(&ThreadPool::workerLoop, this, i));
+}
+
+inline ThreadPool::~ThreadPool() {
+	{
+		unique_lock<mutex> lock(m);
+		stopping = true;
+	}
+	hasWork.notify_all();
+	for (unsigned int i = 0; i < threads.size(); i++)
+		threads[i].join();
+	for (unsigned int i = 0; i < queues.size(); i++)
+		delete queues[i];
+}
+
+/**
+ * @brief Adds a task to the pool. Tasks are distributed round robin over the worker deques.
+ */
+inline void ThreadPool::submit(const Task &task) {
+	unsigned int q;
+	{
+		unique_lock<mutex> lock(m);
+		q = nextQueue;
+		nextQueue = (nextQueue + 1) % queues.size();
+		pending++;
+		queued++; //antes do push, para nunca ser decrementado antes de incrementado
+	}
+	{
+		unique_lock<mutex> lock(queues[q]->m);
+		queues[q]->tasks.push_back(task);
+	}
+	hasWork.notify_one();
+}
+
+/**
+ * @brief Blocks until every submitted task has finished.
+ */
+inline void ThreadPool::wait() {
+	unique_lock<mutex> lock(m);
+	while (pending > 0)
+		allDone.wait(lock);
+}
+
+/**
+ * @brief Takes a task from the worker's own deque (back) or steals one from another deque (front).
+ */
+inline bool ThreadPool::takeTask(unsigned int worker, Task &task) {
+	for (unsigned int i = 0; i < queues.size(); i++) {
+		TaskQueue *q = queues[(worker + i) % queues.size()];
+		unique_lock<mutex> lock(q->m);
+		if (q->tasks.empty())
+			continue;
+		if (i == 0) {
+			task = q->tasks.back();
+			q->tasks.pop_back();
+		} else {
+			task = q->tasks.front();
+			q->tasks.pop_front();
+		}
+		return true;
+	}
+	return false;
+}
+
+inline void ThreadPool::workerLoop(unsigned int worker) {
+	while (true) {
+		{
+			unique_lock<mutex> lock(m);
+			while (queued == 0 && !stopping)
+				hasWork.wait(lock);
+			if (queued == 0 && stopping)
+				return;
+		}
+
+		Task task;
+		if (!takeTask(worker, task))
+			continue; //outro worker ficou com ela entretanto
+		{
+			unique_lock<mutex> lock(m);
+			queued--;
+		}
+
+		task(worker);
+
+		unique_lock<mutex> lock(m);
+		pending--;
+		if (pending == 0)
+			allDone.notify_all();
+	}
+}
+
+#endif /* SRC_THREADPOOL_H_ */
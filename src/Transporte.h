@@ -39,6 +39,22 @@ public:
 		this->custo = custo;
 	}
 
+	double getTempoEspera() const {
+		return tempo_espera;
+	}
+
+	void setTempoEspera(double tempo) {
+		this->tempo_espera = tempo;
+	}
+
+	double getVelocidadeMedia() const {
+		return velocidade_media;
+	}
+
+	void setVelocidadeMedia(double velo) {
+		this->velocidade_media = velo;
+	}
+
 	const string& getNome() const {
 		return nome;
 	}
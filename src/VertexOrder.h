@@ -0,0 +1,162 @@
+/*
+ * VertexOrder.h
+ */
+#ifndef SRC_VERTEXORDER_H_
+#define SRC_VERTEXORDER_H_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include "FrozenGraph.h"
+
+using namespace std;
+
+#define HILBERT_BITS 16 //bits de cada coordenada na curva (grelha de 65536 x 65536)
+
+/** @file */
+
+/*
+ * Vertex orders for FrozenGraph::permuted. The vertices of a map come in the order of the xxx_a.txt
+ * file, with the bus and subway vertices of gera_linhas at the end, so the neighbours of a vertex
+ * are spread over the whole arrays and a search touches a new cache line at almost every edge.
+ * Both orders below put vertices that are near in the map near in memory.
+ */
+
+/**
+ * @brief Position of the cell (x, y) along the Hilbert curve that fills a grid of 2^HILBERT_BITS
+ * cells of side. Cells that are close along the curve are also close in the grid.
+ */
+inline uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+	uint64_t d = 0;
+	for (uint32_t s = 1u << (HILBERT_BITS - 1); s > 0; s >>= 1) {
+		uint32_t rx = (x & s) ? 1 : 0;
+		uint32_t ry = (y & s) ? 1 : 0;
+		d += (uint64_t) s * s * ((3 * rx) ^ ry);
+		//roda o quadrante, para a curva continuar do ponto onde acabou o anterior
+		if (ry == 0) {
+			if (rx == 1) {
+				x = s - 1 - (x & (s - 1));
+				y = s - 1 - (y & (s - 1));
+			}
+			uint32_t t = x;
+			x = y;
+			y = t;
+		}
+	}
+	return d;
+}
+
+/**
+ * @brief Orders the vertices along a Hilbert curve over their longitude and latitude, scaled to the
+ * bounding box of the map. The vertices of the lines have the coordinates of their stops, so they end
+ * up next to the vertices of the streets they are on.
+ * @return the vertices in the new order, for FrozenGraph::permuted
+ */
+template<class T>
+vector<unsigned int> hilbertOrder(const FrozenGraph<T> &grafo) {
+	unsigned int n = grafo.getNumVertex();
+	vector<unsigned int> res(n);
+	if (n == 0)
+		return res;
+	long double minLong = grafo.getInfo(0).longitude, maxLong = minLong;
+	long double minLat = grafo.getInfo(0).latitude, maxLat = minLat;
+	for (unsigned int v = 1; v < n; v++) {
+		const T &info = grafo.getInfo(v);
+		if (info.longitude < minLong)
+			minLong = info.longitude;
+		if (info.longitude > maxLong)
+			maxLong = info.longitude;
+		if (info.latitude < minLat)
+			minLat = info.latitude;
+		if (info.latitude > maxLat)
+			maxLat = info.latitude;
+	}
+	long double lado = (1u << HILBERT_BITS) - 1;
+	long double escalaX = maxLong > minLong ? lado / (maxLong - minLong) : 0;
+	long double escalaY = maxLat > minLat ? lado / (maxLat - minLat) : 0;
+
+	vector<pair<uint64_t, unsigned int> > chaves(n);
+	for (unsigned int v = 0; v < n; v++) {
+		const T &info = grafo.getInfo(v);
+		uint32_t x = (uint32_t) ((info.longitude - minLong) * escalaX);
+		uint32_t y = (uint32_t) ((info.latitude - minLat) * escalaY);
+		chaves[v] = make_pair(hilbertIndex(x, y), v);
+	}
+	//empates (a mesma celula) ficam pela ordem antiga
+	sort(chaves.begin(), chaves.end());
+	for (unsigned int i = 0; i < n; i++)
+		res[i] = chaves[i].second;
+	return res;
+}
+
+/**
+ * @brief Orders the vertices by Cuthill-McKee: a breadth-first search over the edges in both
+ * directions, from a vertex of least degree, visiting the neighbours of each vertex by increasing
+ * degree, so each vertex ends up near its neighbours. Each part of the graph not reached yet starts a
+ * new search, from its vertex of least degree.
+ * @return the vertices in the new order, for FrozenGraph::permuted
+ */
+template<class T>
+vector<unsigned int> cuthillMcKeeOrder(const FrozenGraph<T> &grafo) {
+	unsigned int n = grafo.getNumVertex();
+	vector<unsigned int> grau(n);
+	for (unsigned int v = 0; v < n; v++)
+		grau[v] = grafo.edgesEnd(v) - grafo.edgesBegin(v) + grafo.revEdgesEnd(v)
+				- grafo.revEdgesBegin(v);
+	vector<unsigned int> porGrau(n);
+	for (unsigned int v = 0; v < n; v++)
+		porGrau[v] = v;
+	stable_sort(porGrau.begin(), porGrau.end(),
+			[&grau](unsigned int a, unsigned int b) {
+				return grau[a] < grau[b];
+			});
+
+	vector<unsigned int> res;
+	res.reserve(n);
+	vector<bool> visitado(n, false);
+	vector<unsigned int> vizinhos;
+	for (unsigned int k = 0; k < n; k++) {
+		if (visitado[porGrau[k]])
+			continue;
+		visitado[porGrau[k]] = true;
+		res.push_back(porGrau[k]);
+		//o proprio vetor de resultado serve de fila
+		for (unsigned int head = res.size() - 1; head < res.size(); head++) {
+			unsigned int v = res[head];
+			vizinhos.clear();
+			for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++)
+				if (!visitado[grafo.getTarget(e)]) {
+					visitado[grafo.getTarget(e)] = true;
+					vizinhos.push_back(grafo.getTarget(e));
+				}
+			for (unsigned int e = grafo.revEdgesBegin(v); e < grafo.revEdgesEnd(v);
+					e++)
+				if (!visitado[grafo.getSource(e)]) {
+					visitado[grafo.getSource(e)] = true;
+					vizinhos.push_back(grafo.getSource(e));
+				}
+			stable_sort(vizinhos.begin(), vizinhos.end(),
+					[&grau](unsigned int a, unsigned int b) {
+						return grau[a] < grau[b];
+					});
+			res.insert(res.end(), vizinhos.begin(), vizinhos.end());
+		}
+	}
+	return res;
+}
+
+/**
+ * @return the average distance, in positions, between the two ends of an edge: a measure of how
+ * spread the neighbours of a vertex are in memory
+ */
+template<class T>
+double averageEdgeSpan(const FrozenGraph<T> &grafo) {
+	double soma = 0;
+	for (unsigned int v = 0; v < grafo.getNumVertex(); v++)
+		for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++)
+			soma += v > grafo.getTarget(e) ?
+					v - grafo.getTarget(e) : grafo.getTarget(e) - v;
+	return grafo.getNumEdges() > 0 ? soma / grafo.getNumEdges() : 0;
+}
+
+#endif /* SRC_VERTEXORDER_H_ */
@@ -16,46 +16,68 @@
 #include <vector>
 #include "Graph.h"
 #include "string_find.h"
+#include "MapParser.h"
+#include "MapSnapshot.h"
+#include "GraphBuilder.h"
+#include "NodeIdMap.h"
+#include "ThreadPool.h"
+#include <chrono>
 
 /** @file */
 
+/**
+ * @brief Seconds since inicio, for the LoadStats of abrirFicheiroXY.
+ */
+static double secondsSince(std::chrono::high_resolution_clock::time_point inicio) {
+	return std::chrono::duration_cast<std::chrono::duration<double> >(
+			std::chrono::high_resolution_clock::now() - inicio).count();
+}
+
 /**
  * @brief Method that reads the nodes from a text file and adds them to both GraphViwer and a Graph
+ * The file is parsed on the threads of pool (see parseFileParallel) and the nodes are then added in
+ * the order of the file, each with the next dense id of ids. A node whose id is already in ids is
+ * repeated and only its first line is used.
  * @param A the xxx_a.txt file
- * @param gv the GraphViewer being used
+ * @param gv the GraphViewer being used (NULL to load the graph only)
  * @param grafo the graph being worked on
  * @param corners Struct that contains the latitude and longitude of the map.
  * @param maxXWindow Window max X coordinate size.
  * @param maxYWindow Window max Y coordinate size.
+ * @param ids gets the dense id of each node of the file
+ * @param pool the threads that parse the file
+ * @param stats if not NULL, gets the size of the file, the times taken and the repeated nodes
  */
 void read_nodes_degrees(const std::string& A, GraphViewer*& gv,
 		Graph<NoInfo>& grafo, struct cantos corners, int maxXwindow,
-		int maxYwindow) {
-	ifstream inFile;
-	//Ler o ficheiro A2.txt
-	inFile.open(A);
+		int maxYwindow, NodeIdMap &ids, ThreadPool &pool,
+		LoadStats *stats = NULL) {
+	auto inicio = std::chrono::high_resolution_clock::now();
+	MappedFile inFile(A);
 
-	if (!inFile) {
+	if (!inFile.isOpen()) {
 		cerr << "Unable to open file datafile.txt";
 		exit(1);   // call system to stop
 	}
 
-	std::string line;
-
-	BigAssInteger idNo = 0;
-	long double X = 0;
-	long double Y = 0;
-
-	while (std::getline(inFile, line)) {
-		std::stringstream linestream(line);
-		std::string data;
+	vector<NodeRecord> nos;
+	parseFileParallel(inFile, parseNodeLine, pool, nos);
+	if (stats != NULL) {
+		stats->bytes[0] = inFile.size();
+		stats->parseSeconds[0] = secondsSince(inicio);
+	}
 
-		linestream >> idNo;
+	inicio = std::chrono::high_resolution_clock::now();
+	grafo.reserve(grafo.getNumVertex() + nos.size());
+	ids.reserve(ids.size() + nos.size());
+	unsigned int repetidos = ids.getNumRepeated();
+	for (unsigned int i = 0; i < nos.size(); i++) {
+		unsigned int idNo;
+		if (!ids.add(nos[i].idNo, idNo))
+			continue; //o mesmo no duas vezes no xxx_a.txt, fica a primeira
 
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;). LATITUDE
-		linestream >> Y;
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;). LONGITUDE
-		linestream >> X;    //X and Y are in degrees
+		long double X = nos[i].longitudeGraus;
+		long double Y = nos[i].latitudeGraus;    //X and Y are in degrees
 
 		long double x = ((X * 100000) - (corners.minLong * 100000))
 				* (maxXwindow
@@ -67,162 +89,141 @@ void read_nodes_degrees(const std::string& A, GraphViewer*& gv,
 								/ ((corners.maxLat * 100000)
 										- (corners.minLat * 100000)));
 
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
-		linestream >> X;
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
-		linestream >> Y;    //X and Y are in radians
+		NoInfo temp(idNo, nos[i].longitude, nos[i].latitude); //x long, y lat (radianos)
 
-		NoInfo temp(idNo % 100000000, X, Y); //x long, y lat
-
-		gv->addNode(idNo % 100000000, x, maxYwindow - y);
-		//cout << "x: " << x << " y: " << y << endl;
+		if (gv != NULL)
+			gv->addNode(idNo, x, maxYwindow - y);
 		grafo.addVertex(temp);
-
 	}
-
-	inFile.close();
+	repetidos = ids.getNumRepeated() - repetidos;
+	if (repetidos > 0)
+		cerr << A << ": " << repetidos << " repeated node ids ignored" << endl;
+	if (stats != NULL) {
+		stats->graphSeconds += secondsSince(inicio);
+		stats->repeatedNodes = repetidos;
+	}
 }
 
 /**
  * @brief Method that reads the edges from a text file and adds them to both a GraphViwer and a Graph. Also calculates the weight of the edge wich is added to the Graph
+ * The file is parsed on the threads of pool (see parseFileParallel). The edges get their ids in the order
+ * of the file and are added to the graph at once by a GraphBuilder, one per source and destination.
+ * Edges to nodes that aren't in ids are ignored.
+ * @param arestas the streets read by read_edges_names
  * @param C xxx_c.txt file
- * @param gv the GraphViewer being used
+ * @param gv the GraphViewer being used (NULL to load the graph only)
  * @param grafo the graph being worked on
+ * @param ids the dense ids of the nodes, from read_nodes_degrees
+ * @param pool the threads that parse the file
+ * @param stats if not NULL, gets the size of the file and the times taken
+ * @param ruaDaAresta if not NULL, gets the street id of each edge id
  */
-void read_edges(unordered_set<Aresta, hashFuncAresta, hashFuncAresta> arestas,
-		const std::string& C, GraphViewer*& gv, Graph<NoInfo>& grafo) {
-
-	ifstream inFile;
-	string line;
-
-	inFile.open(C);
-
-	if (!inFile) {
+void read_edges(const unordered_set<Aresta, hashFuncAresta, hashFuncAresta> &arestas,
+		const std::string& C, GraphViewer*& gv, Graph<NoInfo>& grafo,
+		const NodeIdMap &ids, ThreadPool &pool, LoadStats *stats = NULL,
+		vector<BigAssInteger> *ruaDaAresta = NULL) {
+	auto inicio = std::chrono::high_resolution_clock::now();
+	MappedFile inFile(C);
+
+	if (!inFile.isOpen()) {
 		cerr << "Unable to open file datafile.txt";
 		exit(1);   // call system to stop
 	}
 
-	BigAssInteger idAresta;
-	BigAssInteger idNo1;
-	BigAssInteger idNo2;
+	vector<EdgeRecord> registos;
+	parseFileParallel(inFile, parseEdgeLine, pool, registos);
+	if (stats != NULL) {
+		stats->bytes[2] = inFile.size();
+		stats->parseSeconds[2] = secondsSince(inicio);
+	}
 
+	inicio = std::chrono::high_resolution_clock::now();
+	GraphBuilder<NoInfo> construtor(grafo);
+	construtor.reserve(2 * registos.size());
 	BigAssInteger i = 0;
-	while (std::getline(inFile, line)) {
-		std::stringstream linestream(line);
-		std::string data;
-		linestream >> idAresta;
+	for (unsigned int r = 0; r < registos.size(); r++) {
+		unsigned int idNo1 = ids.find(registos[r].idNo1);
+		unsigned int idNo2 = ids.find(registos[r].idNo2);
+		if (idNo1 == NodeIdMap::NO_ID || idNo2 == NodeIdMap::NO_ID)
+			continue; //aresta para um no que nao esta no xxx_a.txt
 		Aresta temp;
-		temp.idAresta = idAresta;
-		unordered_set<Aresta, hashFuncAresta, hashFuncAresta>::iterator itAre =
+		temp.idAresta = registos[r].idAresta;
+		unordered_set<Aresta, hashFuncAresta, hashFuncAresta>::const_iterator itAre =
 				arestas.find(temp);
 
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
-		linestream >> idNo1;
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
-		linestream >> idNo2;    //X and Y are in degrees
-
-		NoInfo origem(idNo1 % 100000000, 0, 0);  //so para efeitos de pesquisa
-		Vertex<NoInfo>* source = grafo.getVertex(origem);
-		NoInfo destino(idNo2 % 100000000, 0, 0);
-		Vertex<NoInfo>* destiny = grafo.getVertex(destino);
-
-		//pre processamento do grafico pelo parser ja garante informacao sem erros //i think
-		if (grafo.removeEdge(origem, destino)) //conseguiu remover
-				{
-			grafo.addEdge(origem, destino,
-					haversine_km(source->getInfo().latitude,
-							source->getInfo().longitude,
-							destiny->getInfo().latitude,
-							destiny->getInfo().longitude) / VELOCIDADE_PE, i);
-		}
-		grafo.addEdge(origem, destino,
-				haversine_km(source->getInfo().latitude,
-						source->getInfo().longitude,
-						destiny->getInfo().latitude,
-						destiny->getInfo().longitude) / VELOCIDADE_PE, i);
+		NoInfo origem(idNo1, 0, 0);  //so para efeitos de pesquisa
+		NoInfo destino(idNo2, 0, 0);
+		if (!construtor.addEdge(origem, destino, i))
+			continue;
+		if (ruaDaAresta != NULL)
+			ruaDaAresta->push_back(temp.idAresta);
 
-		gv->addEdge(i, idNo1 % 100000000, idNo2 % 100000000,
-				EdgeType::DIRECTED);
-		gv->setVertexColor(idNo1 % 100000000, GREEN);
+		if (gv != NULL) {
+			gv->addEdge(i, idNo1, idNo2, EdgeType::DIRECTED);
+			gv->setVertexColor(idNo1, GREEN);
+		}
 
-		if (itAre->dois_sentidos) {
+		if (itAre != arestas.end() && itAre->dois_sentidos) {
 			i++;
-			grafo.addEdge(destino, origem,
-					haversine_km(source->getInfo().getLatitude(),
-							source->getInfo().getLongitude(),
-							destiny->getInfo().getLatitude(),
-							destiny->getInfo().getLongitude()) / VELOCIDADE_PE,
-					i); //distancia entre A e B == distancia entre B e A;
-			gv->addEdge(i, idNo2 % 100000000, idNo1 % 100000000,
-					EdgeType::DIRECTED);
-			gv->setVertexColor(idNo2 % 100000000, GREEN);
+			construtor.addEdge(destino, origem, i);
+			if (ruaDaAresta != NULL)
+				ruaDaAresta->push_back(temp.idAresta);
+			if (gv != NULL) {
+				gv->addEdge(i, idNo2, idNo1, EdgeType::DIRECTED);
+				gv->setVertexColor(idNo2, GREEN);
+			}
 		}
 		i++;
-
 	}
-	inFile.close();
+
+	//as arestas repetidas (mesma origem e destino) ficam so uma vez, com o id da ultima
+	GeoPoints pontos(grafo); //a trigonometria de cada no uma so vez, nao a de cada aresta
+	construtor.build([&pontos](const unsigned int *o, const unsigned int *d,
+			unsigned int n, double *pesos) {
+		pontos.distancesKm(o, d, n, pesos); //distancia entre A e B == distancia entre B e A
+		for (unsigned int i = 0; i < n; i++)
+			pesos[i] /= VELOCIDADE_PE;
+	});
+	if (stats != NULL)
+		stats->duplicateEdges = construtor.getNumDuplicates();
+	if (stats != NULL)
+		stats->graphSeconds += secondsSince(inicio);
 }
 
 /**
  * @brief Method to assign a name to an Edge and determine if it is one or two ways.
  * @param B xxx_b.txt file
+ * @param pool the threads that parse the file
+ * @param stats if not NULL, gets the size of the file and the times taken
+ * @param lista if not NULL, gets the streets in the order of the file
  */
 unordered_set<Aresta, hashFuncAresta, hashFuncAresta> read_edges_names(
-		const std::string& B) {
-	ifstream inFile;
-	string line;
+		const std::string& B, ThreadPool &pool, LoadStats *stats = NULL,
+		vector<Aresta> *lista = NULL) {
+	auto inicio = std::chrono::high_resolution_clock::now();
+	MappedFile inFile(B);
 	unordered_set<Aresta, hashFuncAresta, hashFuncAresta> arestas;
-	//unordered_set<Aresta> arestas;
-
-	inFile.open(B);
 
-	if (!inFile) {
+	if (!inFile.isOpen()) {
 		cerr << "Unable to open file B2.txt";
 		exit(1);   // call system to stop
 	}
 
-	BigAssInteger idAresta = 0;
-	string Rua = "";
-	string dois_sent = "False";
-
-	while (std::getline(inFile, line)) {
-		std::stringstream linestream(line);
-		std::string data;
-
-		linestream >> idAresta;
-
-		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
-
-		char teste;
-		linestream >> teste;
-		if (teste == ';') {
-			Rua = "unnamed";
-
-		} else {
-			string resto;
-			std::getline(linestream, resto, ';');
-			Rua = teste;
-			Rua = teste + resto;
-		}
-
-		linestream >> dois_sent;
-
-		Aresta temp;
-		temp.origem = NoInfo(0, 0, 0);
-		temp.destino = NoInfo(0, 0, 0);
-		temp.distancia = 0;
-		temp.idAresta = idAresta;
-		temp.rua = Rua;
-		if (dois_sent == "True")
-			temp.dois_sentidos = true;
-		else if (dois_sent == "False")
-			temp.dois_sentidos = false;
-
-		arestas.insert(temp);
-
+	vector<Aresta> ruas;
+	parseFileParallel(inFile, parseStreetLine, pool, ruas);
+	if (stats != NULL) {
+		stats->bytes[1] = inFile.size();
+		stats->parseSeconds[1] = secondsSince(inicio);
 	}
 
-	inFile.close();
+	inicio = std::chrono::high_resolution_clock::now();
+	arestas.reserve(ruas.size());
+	for (unsigned int i = 0; i < ruas.size(); i++)
+		arestas.insert(ruas[i]);
+	if (stats != NULL)
+		stats->graphSeconds += secondsSince(inicio);
+	if (lista != NULL)
+		lista->swap(ruas);
 
 	return arestas;
 }
@@ -233,25 +234,122 @@ unordered_set<Aresta, hashFuncAresta, hashFuncAresta> read_edges_names(
  * @param B Street name file to be read.
  * @param C Edges file to be read.
  * @param grafo graph that will be modified when reading the files.
- * @param gv graphviewer that is going to represent the graph.
+ * @param gv graphviewer that is going to represent the graph (NULL to load the graph only).
  * @param corners Struct that contains the latitude and longitude of the map.
  * @param maxXWindow Window max X coordinate size.
  * @param maxYWindow Window max Y coordinate size.
+ * @param stats if not NULL, gets the size of each file, its parsing time and the time spent adding
+ * everything to the graph.
+ * @param ruas if not NULL, gets the streets of the map and the street of each edge (for a snapshot).
+ * @param ids if not NULL, gets the dense id of each node id of the files (needed to translate the node
+ * ids of the files, and back).
  */
 void abrirFicheiroXY(const std::string& A, const std::string& B,
 		const std::string& C, Graph<NoInfo>& grafo, GraphViewer*& gv,
-		struct cantos corners, int maxXwindow, int maxYwindow) {
-
-	ifstream inFile;
-	std::string line;
+		struct cantos corners, int maxXwindow, int maxYwindow,
+		LoadStats *stats = NULL, MapStreets *ruas = NULL,
+		NodeIdMap *ids = NULL) {
+	ThreadPool pool(thread::hardware_concurrency());
+	NodeIdMap idsLocal;
+	if (ids == NULL)
+		ids = &idsLocal;
 
-	read_nodes_degrees(A, gv, grafo, corners, maxXwindow, maxYwindow);
+	read_nodes_degrees(A, gv, grafo, corners, maxXwindow, maxYwindow, *ids,
+			pool, stats);
 
 	unordered_set<Aresta, hashFuncAresta, hashFuncAresta> arestas =
-			read_edges_names(B);
+			read_edges_names(B, pool, stats, ruas == NULL ? NULL : &ruas->ruas);
 
 	//abrir C2.txt sao as arestas
-	read_edges(arestas, C, gv, grafo);
+	read_edges(arestas, C, gv, grafo, *ids, pool, stats,
+			ruas == NULL ? NULL : &ruas->ruaDaAresta);
+}
+
+/**
+ * @brief Loads a map from its snapshot (see MapSnapshot.h), with no parsing. If there is no valid
+ * snapshot of this map (or the text files changed since it was written), the text files are read with
+ * abrirFicheiroXY and a new snapshot is written for the next runs.
+ * @param radical the filename radical of the text files (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ * @param snapshot the snapshot file ("" to always read the text files)
+ * @param grafo graph that will be modified when reading the files.
+ * @param gv graphviewer that is going to represent the graph (NULL to load the graph only).
+ * @param corners Struct that contains the latitude and longitude of the map.
+ * @param maxXWindow Window max X coordinate size.
+ * @param maxYWindow Window max Y coordinate size.
+ * @param ids if not NULL (and empty), gets the dense id of each node id of the map files
+ * @return true if the graph came from the snapshot
+ */
+bool abrirMapa(const std::string& radical, const std::string& snapshot,
+		Graph<NoInfo>& grafo, GraphViewer*& gv, struct cantos corners,
+		int maxXwindow, int maxYwindow, NodeIdMap *ids = NULL) {
+	NodeIdMap idsLocal;
+	if (ids == NULL)
+		ids = &idsLocal;
+	if (snapshot != "") {
+		try {
+			GraphSnapshot mapa(snapshot, radical);
+			mapa.toGraph(grafo, ids);
+			if (gv != NULL) {
+				//o snapshot so guarda radianos, a janela usa graus
+				for (unsigned int v = 0; v < mapa.getNumVertex(); v++) {
+					NoInfo info = mapa.getInfo(v);
+					long double X = info.longitude * 180 / M_PI;
+					long double Y = info.latitude * 180 / M_PI;
+					long double x = ((X * 100000) - (corners.minLong * 100000))
+							* (maxXwindow
+									/ ((corners.maxLong * 100000)
+											- (corners.minLong * 100000)));
+					long double y = ((Y * 100000) - (corners.minLat * 100000))
+							* (maxYwindow
+									/ ((corners.maxLat * 100000)
+											- (corners.minLat * 100000)));
+					gv->addNode(info.idNo, x, maxYwindow - y);
+				}
+				//as arestas repetidas tem o mesmo id, o GraphViewer so recebe uma
+				vector<bool> desenhada;
+				for (unsigned int v = 0; v < mapa.getNumVertex(); v++)
+					for (unsigned int e = mapa.edgesBegin(v); e < mapa.edgesEnd(v); e++) {
+						unsigned long long id = mapa.getEdgeId(e);
+						if (id >= desenhada.size())
+							desenhada.resize(id + 1, false);
+						if (desenhada[id])
+							continue;
+						desenhada[id] = true;
+						gv->addEdge(id, mapa.getInfo(v).idNo,
+								mapa.getInfo(mapa.getTarget(e)).idNo,
+								EdgeType::DIRECTED);
+						gv->setVertexColor(mapa.getInfo(v).idNo, GREEN);
+					}
+			}
+			return true;
+		} catch (runtime_error & e) {
+			cerr << e.what() << ", reading the text files" << endl;
+			ids->clear();
+		}
+	}
+
+	MapStreets ruas;
+	abrirFicheiroXY(radical + "_a.txt", radical + "_b.txt", radical + "_c.txt",
+			grafo, gv, corners, maxXwindow, maxYwindow, NULL,
+			snapshot == "" ? NULL : &ruas, ids);
+	if (snapshot != "") {
+		try {
+			writeSnapshot(snapshot, radical, grafo, ruas, *ids);
+		} catch (runtime_error & e) {
+			cerr << e.what() << endl;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Time (hours) from a stop of a line to the next one, at the speed of the line. The stops sit on the
+ * street vertices a and b of the line, whose points are in pontos.
+ */
+long double tempoEntreParagens(const Graph<NoInfo>& data, const GeoPoints& pontos,
+		const NoInfo& a, const NoInfo& b, long double velocidade) {
+	return pontos.distanceKm(data.getVertex(a)->getIndex(),
+			data.getVertex(b)->getIndex()) / velocidade;
 }
 
 /**
@@ -274,6 +372,9 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 	Vertex<NoInfo> * vertice_des = NULL;
 	//linha proposta
 	vector<NoInfo> linha_provisoria;
+	SearchWorkspace<long double> ws;
+	//as paragens ficam nos pontos dos vertices das ruas, a trigonometria de cada um so uma vez
+	GeoPoints pontos(data);
 
 	//gerar linhas de autocarro
 	unsigned int numero_linhas_autocarro = 0;
@@ -293,9 +394,11 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 			continue;
 
 		linha_provisoria = data.getDijkstraPath(vertice_ori->getInfo(),
-				vertice_des->getInfo());
+				vertice_des->getInfo(), ws);
 		if (linha_provisoria.size() < comp_autocarro)
 			continue;
+		//o caminho pode passar pelas paragens de linhas ja geradas
+		pontos.addNewVertices(data);
 
 		//cria linha autocarro equivalente  provisoria mas com layer A;
 		vector<NoInfo> linha_autocarro;
@@ -317,10 +420,8 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 				//adiciona o no seguinte frente
 				data.addVertex(linha_autocarro[indice_paragem+1]);
 				//liga caminho do autocarro com o no da frente
-				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],haversine_km(linha_autocarro[indice_paragem].latitude,
-										linha_autocarro[indice_paragem].longitude,
-										linha_autocarro[indice_paragem+1].latitude,
-										linha_autocarro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_AUTOCARRO));
 
 
 			}//inicial
@@ -335,10 +436,8 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 				//adiciona o no seguinte frente
 				data.addVertex(linha_autocarro[indice_paragem+1]);
 				//liga caminho do autocarro
-				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],haversine_km(linha_autocarro[indice_paragem].latitude,
-						linha_autocarro[indice_paragem].longitude,
-						linha_autocarro[indice_paragem+1].latitude,
-						linha_autocarro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_AUTOCARRO));
 
 			} //no final
 			else if(indice_paragem ==  (linha_provisoria.size()-1)){
@@ -367,10 +466,12 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 			continue;
 
 		linha_provisoria = data.getDijkstraPath(vertice_ori->getInfo(),
-				vertice_des->getInfo());
+				vertice_des->getInfo(), ws);
 
 		if (linha_provisoria.size() < comp_metro)
 			continue;
+		//o caminho pode passar pelas paragens de linhas ja geradas
+		pontos.addNewVertices(data);
 
 		/////
 		//cria linha metro equivalente  provisoria mas com layer M;
@@ -393,10 +494,8 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 				//adiciona o no seguinte frente
 				data.addVertex(linha_metro[indice_paragem+1]);
 				//liga caminho do metro com o no da frente
-				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],haversine_km(linha_metro[indice_paragem].latitude,
-						linha_metro[indice_paragem].longitude,
-						linha_metro[indice_paragem+1].latitude,
-						linha_metro[indice_paragem+1].longitude) / VELOCIDADE_METRO);
+				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_METRO));
 
 
 			}//inicial
@@ -411,10 +510,8 @@ vector<vector<NoInfo>> gera_linhas(Graph<NoInfo>& data, unsigned int linhas_metr
 				//adiciona o no seguinte frente
 				data.addVertex(linha_metro[indice_paragem+1]);
 				//liga caminho do metro
-				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],haversine_km(linha_metro[indice_paragem].latitude,
-						linha_metro[indice_paragem].longitude,
-						linha_metro[indice_paragem+1].latitude,
-						linha_metro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_METRO));
 
 			} //no final
 			else if(indice_paragem ==  (linha_provisoria.size()-1)){
@@ -451,6 +548,9 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 	Vertex<NoInfo> * vertice_des = NULL;
 	//linha proposta
 	vector<NoInfo> linha_provisoria;
+	SearchWorkspace<long double> ws;
+	//as paragens ficam nos pontos dos vertices das ruas, a trigonometria de cada um so uma vez
+	GeoPoints pontos(data);
 
 	//gerar linhas de autocarro
 	unsigned int numero_linhas_autocarro = 0;
@@ -470,9 +570,11 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 			continue;
 
 		linha_provisoria = data.getDijkstraPath(vertice_ori->getInfo(),
-				vertice_des->getInfo());
+				vertice_des->getInfo(), ws);
 		if (linha_provisoria.size() < comp_autocarro || linha_provisoria.size()  > (comp_autocarro + DELTA_TAMANHO_PARAGENS))
 			continue;
+		//o caminho pode passar pelas paragens de linhas ja geradas
+		pontos.addNewVertices(data);
 
 		//cria linha autocarro equivalente  provisoria mas com layer A;
 		vector<NoInfo> linha_autocarro;
@@ -494,10 +596,8 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 				//adiciona o no seguinte frente
 				data.addVertex(linha_autocarro[indice_paragem+1]);
 				//liga caminho do autocarro com o no da frente
-				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],haversine_km(linha_autocarro[indice_paragem].latitude,
-										linha_autocarro[indice_paragem].longitude,
-										linha_autocarro[indice_paragem+1].latitude,
-										linha_autocarro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_AUTOCARRO));
 
 
 			}//inicial
@@ -512,10 +612,8 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 				//adiciona o no seguinte frente
 				data.addVertex(linha_autocarro[indice_paragem+1]);
 				//liga caminho do autocarro
-				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],haversine_km(linha_autocarro[indice_paragem].latitude,
-						linha_autocarro[indice_paragem].longitude,
-						linha_autocarro[indice_paragem+1].latitude,
-						linha_autocarro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_autocarro[indice_paragem], linha_autocarro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_AUTOCARRO));
 
 			} //no final
 			else if(indice_paragem ==  (linha_provisoria.size()-1)){
@@ -544,10 +642,12 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 			continue;
 
 		linha_provisoria = data.getDijkstraPath(vertice_ori->getInfo(),
-				vertice_des->getInfo());
+				vertice_des->getInfo(), ws);
 
 		if (linha_provisoria.size() < comp_metro || linha_provisoria.size() > (comp_metro + DELTA_TAMANHO_PARAGENS))
 			continue;
+		//o caminho pode passar pelas paragens de linhas ja geradas
+		pontos.addNewVertices(data);
 
 		/////
 		//cria linha metro equivalente  provisoria mas com layer M;
@@ -570,10 +670,8 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 				//adiciona o no seguinte frente
 				data.addVertex(linha_metro[indice_paragem+1]);
 				//liga caminho do metro com o no da frente
-				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],haversine_km(linha_metro[indice_paragem].latitude,
-						linha_metro[indice_paragem].longitude,
-						linha_metro[indice_paragem+1].latitude,
-						linha_metro[indice_paragem+1].longitude) / VELOCIDADE_METRO);
+				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_METRO));
 
 
 			}//inicial
@@ -588,10 +686,8 @@ vector<vector<NoInfo>> gera_linhas_nomes(Graph<NoInfo>& data, unsigned int linha
 				//adiciona o no seguinte frente
 				data.addVertex(linha_metro[indice_paragem+1]);
 				//liga caminho do metro
-				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],haversine_km(linha_metro[indice_paragem].latitude,
-						linha_metro[indice_paragem].longitude,
-						linha_metro[indice_paragem+1].latitude,
-						linha_metro[indice_paragem+1].longitude) / VELOCIDADE_AUTOCARRO);
+				data.addEdge(linha_metro[indice_paragem], linha_metro[indice_paragem+1],tempoEntreParagens(data, pontos, linha_provisoria[indice_paragem],
+						linha_provisoria[indice_paragem+1], VELOCIDADE_METRO));
 
 			} //no final
 			else if(indice_paragem ==  (linha_provisoria.size()-1)){
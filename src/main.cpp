@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cstdlib>
 #include <cmath>
 #include <string>
 #include <map>
@@ -6,51 +7,24 @@
 #include <unordered_set>
 #include <utility>
 #include <time.h>
+#include <thread>
 #include "utils.h"
 #include "aresta.h"
 #include "map_tests.h"
 #include "string_find.h"
 #include "file_reading.h"
+#include "BatchQueries.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "MultilevelOverlay.h"
+#include "SpatialIndex.h"
+#include "VertexOrder.h"
 
 #define PARAGENS_APROX 10
 #define REPETE_ALGORITS 100
 #define REPETE_PARTIAL 200
 /** @file */
 
-template<>
-struct vertex_greater_than<long double> {
-	bool operator()(Vertex<NoInfo> * a, Vertex<NoInfo> * b) const {
-		return a->getDist() > b->getDist();
-	}
-};
-
-template<>  //for A*
-struct vertex_greater_than_A<long double> {
-	bool operator()(Vertex<NoInfo> * a, Vertex<NoInfo> * b) const {
-		return ((a->getDist() + a->getDestinyDistance())
-				> (b->getDist() + b->getDestinyDistance()));
-	}
-};
-
-template<>
-struct heuristicFunc<NoInfo> {
-	NoInfo destino;
-	bool operator()(Vertex<NoInfo> * a, Vertex<NoInfo> * b) {
-		long double distOri = haversine_km(a->getInfo().latitude,
-				a->getInfo().longitude, destino.latitude, destino.longitude)
-				+ a->getDist();
-		long double distDest = haversine_km(b->getInfo().latitude,
-				b->getInfo().longitude, destino.latitude, destino.longitude)
-				+ b->getDist();
-		return (distOri > distDest ? true : false);
-	}
-	//no longer needed
-	long double operator()(Vertex<NoInfo> * a) const {
-		return haversine_km(a->getInfo().latitude, a->getInfo().longitude,
-				destino.latitude, destino.longitude);
-	}
-};
-
 /**
  * @brief Opens the data files and populates a graph.
  * @param A the "xxx_a.txt" file
@@ -74,6 +48,8 @@ void abrirFicheiros(string A, string B, string C, Graph<NoInfo> & grafo,
 	std::string line;
 
 	BigAssInteger idNo = 0;
+	NodeIdMap ids;
+	unsigned int idDenso;
 	long double X = 0;
 	long double Y = 0;
 
@@ -93,8 +69,10 @@ void abrirFicheiros(string A, string B, string C, Graph<NoInfo> & grafo,
 		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
 		linestream >> Y;    //X and Y are in radians
 		//cout << "idNo: " << idNo << " long: " << X << " lat: " << Y << endl;
-		NoInfo temp(idNo % 100000000, X, Y);
-		gv->addNode(idNo % 100000000);
+		if (!ids.add(idNo, idDenso))
+			continue; //no repetido, fica o primeiro
+		NoInfo temp(idDenso, X, Y);
+		gv->addNode(idDenso);
 		grafo.addVertex(temp);
 
 	}
@@ -114,6 +92,7 @@ void abrirFicheiros(string A, string B, string C, Graph<NoInfo> & grafo,
 	BigAssInteger idNo2;
 
 	BigAssInteger i = 0;
+	GraphBuilder<NoInfo> construtor(grafo);
 
 	while (std::getline(inFile, line)) {
 		std::stringstream linestream(line);
@@ -126,32 +105,22 @@ void abrirFicheiros(string A, string B, string C, Graph<NoInfo> & grafo,
 		std::getline(linestream, data, ';'); // read up-to the first ; (discard ;).
 		linestream >> idNo2;    //X and Y are in degrees
 
-		NoInfo origem(idNo1 % 100000000, 0, 0);  //so para efeitos de pesquisa
-		Vertex<NoInfo>* source = grafo.getVertex(origem);
-		NoInfo destino(idNo2 % 100000000, 0, 0);
-		Vertex<NoInfo>* destiny = grafo.getVertex(destino);
-
-		//pre processamento do grafico pelo parser ja garante informacao sem erros //i think
+		NoInfo origem(ids.find(idNo1), 0, 0);  //so para efeitos de pesquisa
+		NoInfo destino(ids.find(idNo2), 0, 0);
 
-		if (grafo.removeEdge(origem, destino)) //conseguiu remover
-				{
-			grafo.addEdge(origem, destino,
-					haversine_km(source->getInfo().latitude,
-							source->getInfo().longitude,
-							destiny->getInfo().latitude,
-							destiny->getInfo().longitude), i);
+		//as arestas repetidas ficam so uma vez (ver GraphBuilder)
+		if (construtor.addEdge(origem, destino, i)) {
+			gv->addEdge(i, origem.idNo, destino.idNo, EdgeType::DIRECTED);
+			gv->setVertexColor(origem.idNo, GREEN);
 		}
-		grafo.addEdge(origem, destino,
-				haversine_km(source->getInfo().latitude,
-						source->getInfo().longitude,
-						destiny->getInfo().latitude,
-						destiny->getInfo().longitude), i);
-		gv->addEdge(i, idNo1 % 100000000, idNo2 % 100000000,
-				EdgeType::DIRECTED);
-		gv->setVertexColor(idNo1 % 100000000, GREEN);
 		i++;
 
 	}
+	GeoPoints pontos(grafo);
+	construtor.build([&pontos](const unsigned int *o, const unsigned int *d,
+			unsigned int n, double *pesos) {
+		pontos.distancesKm(o, d, n, pesos);
+	});
 	gv->rearrange();
 	inFile.close();
 }
@@ -167,6 +136,7 @@ void abrirFicheiros(string A, string B, string C, Graph<NoInfo> & grafo,
 void teste_colorir(Graph<NoInfo>& data, GraphViewer*& gv, int numCaminhos,
 		unsigned int sizeCaminhos, Vertex<NoInfo>* source,
 		Vertex<NoInfo>* destiny, string cor) {
+	SearchWorkspace<long double> ws;
 
 	if (source == NULL || destiny == NULL) {
 		int i = 0;
@@ -181,7 +151,7 @@ void teste_colorir(Graph<NoInfo>& data, GraphViewer*& gv, int numCaminhos,
 				continue;
 
 			vector<NoInfo> path = data.getDijkstraPath(ori->getInfo(),
-					des->getInfo());
+					des->getInfo(), ws);
 
 			if (path.size() < sizeCaminhos)
 				continue;
@@ -236,7 +206,7 @@ void teste_colorir(Graph<NoInfo>& data, GraphViewer*& gv, int numCaminhos,
 
 	else {
 		vector<NoInfo> path = data.getDijkstraPath(source->getInfo(),
-				destiny->getInfo());
+				destiny->getInfo(), ws);
 
 		for (unsigned int i = 0; i < path.size(); i++) {
 			Sleep(100);
@@ -259,18 +229,60 @@ void teste_colorir(Graph<NoInfo>& data, GraphViewer*& gv, int numCaminhos,
 	}
 }
 
+/**
+ * @brief The comma separated filename radicals of a list (e.g. "Porto,Rome,Dublin").
+ */
+static vector<string> lerRadicais(const char *lista) {
+	vector<string> radicais;
+	stringstream ss(lista);
+	string radical;
+	while (getline(ss, radical, ','))
+		radicais.push_back(radical);
+	return radicais;
+}
+
+/**
+ * A test over a list of maps, with the subway and bus lines of argv[4..7], and the argv[1] that calls it.
+ */
+struct testeMapas {
+	const char *modo;
+	void (*teste)(const vector<string>& radicais, int linhas_metro,
+			int linhas_autocarro, int comp_metro, int comp_autocarro);
+};
+
+static const testeMapas TESTES_MAPAS[] = {
+	{ "labels", testHubLabels },
+	{ "overlay", testCustomization },
+	{ "sssp", testOneToAll },
+	{ "layout", testMemoryLayout },
+	{ "order", testVertexOrder },
+	{ "policies", testGraphPolicies } };
+
 /**
  * The main function.
  *
  * It receives up to 14 arguments:
- *  - argv[1]  Start node (node number), assess connectivity ("Connectivity"), complexity ("comp") or auto ("auto")
- *             or exact string search ("StringSearchExact") or approximate string search ("StringSearchAprox");
- *  - argv[2]  End node (argv[1] = node number, end node number) or number of paths (argv[1] = "auto", 1-5)
- *	- argv[3]  Algorithm to use (if there's a start node or auto, "A*", "Dijkstra" or "Floyd-Warshall")
- *	- argv[4]  Number of subway lines (if there's a start node or auto, 1-10)
- *	- argv[5]  Length of subway lines (if there's a start node or auto, {10, 20, 30, 40, 50})
- *	- argv[6]  Number of bus lines (if there's a start node or auto, 1-20)
- *	- argv[7]  Length of bus lines (if there's a start node or auto, {10, 20, 30, 40, 50})
+ *  - argv[1]  Start node (node id of the map files), route between coordinates ("coords"), assess connectivity ("Connectivity"), complexity ("comp") or auto ("auto")
+ *             or exact string search ("StringSearchExact") or approximate string search ("StringSearchAprox")
+ *             or map loading times ("load") or batch route queries ("batch") or hub labeling tests ("labels")
+ *             or multilevel overlay customization tests ("overlay")
+ *             or one-to-all distance tests ("sssp")
+ *             or memory layout tests ("layout")
+ *             or vertex order tests ("order")
+ *             or graph policy tests ("policies");
+ *  - argv[2]  End node (argv[1] = node id, end node id)
+ *             or start and end coordinates in degrees (argv[1] = "coords", "lat,long,lat,long"), each
+ *             snapped to the nearest node on foot
+ *             or number of paths (argv[1] = "auto", 1-5)
+ *             or comma separated filename radicals (argv[1] = "load", "labels", "overlay", "sssp", "layout", "order" or "policies", e.g. "Porto,Rome,Dublin")
+ *             or file with one "origin;destination" pair per line (argv[1] = "batch")
+ *	- argv[3]  Algorithm to use (if there's a start node or auto, "A*", "ALT", "Dijkstra", "Radix"
+ *	           (Dijkstra over integer weights), "BiDijkstra", "BiA*", "Floyd-Warshall", "CH", "HL" or "CRP";
+ *	           if batch, "A*" or "Dijkstra")
+ *	- argv[4]  Number of subway lines (if there's a start node, auto, labels, overlay, sssp, layout, order or policies, 1-10)
+ *	- argv[5]  Length of subway lines (if there's a start node, auto, labels, overlay, sssp, layout, order or policies, {10, 20, 30, 40, 50})
+ *	- argv[6]  Number of bus lines (if there's a start node, auto, labels, overlay, sssp, layout, order or policies, 1-20)
+ *	- argv[7]  Length of bus lines (if there's a start node, auto, labels, overlay, sssp, layout, order or policies, {10, 20, 30, 40, 50})
  *	- argv[8]  Filename radical (e.g. xxx.png, xxxA.txt, xxxB.txt, xxxC.txt)
  *	- argv[9]  Map image width
  *	- argv[10] Map image height
@@ -278,17 +290,112 @@ void teste_colorir(Graph<NoInfo>& data, GraphViewer*& gv, int numCaminhos,
  *	- argv[12] Lower latitude value
  *	- argv[13] Highest longitude value
  *	- argv[14] Highest latitude value
+ *
+ * "--snapshot <file>" may be added anywhere among the arguments: the map of argv[8] is then loaded from
+ * that binary snapshot instead of the text files, or, if there is no valid snapshot of that map there
+ * yet (or its text files changed since it was written), read from the text files and saved to it (see
+ * MapSnapshot.h).
  */
 int main(int argc, char * argv[]) {
 	srand(time(NULL));
 	vector<vector<NoInfo>> linhas_geradas;
 
+	//tira "--snapshot <ficheiro>" dos argumentos, as posicoes dos outros ficam como sempre
+	string snapshot = "";
+	for (int i = 1; i + 1 < argc; i++)
+		if (strcmp(argv[i], "--snapshot") == 0) {
+			snapshot = argv[i + 1];
+			for (int j = i; j + 2 < argc; j++)
+				argv[j] = argv[j + 2];
+			argc -= 2;
+			break;
+		}
+
 	if (argc != 15) {
 		cout << "There was an input error, please contact the developers."
 				<< endl;
 		return 1;
 	}
 
+	if (strcmp(argv[1], "load") == 0) {
+		testLoadTimes(lerRadicais(argv[2]));
+		cout << "END" << endl;
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < sizeof(TESTES_MAPAS) / sizeof(TESTES_MAPAS[0]);
+			i++)
+		if (strcmp(argv[1], TESTES_MAPAS[i].modo) == 0) {
+			try {
+				TESTES_MAPAS[i].teste(lerRadicais(argv[2]), atoi(argv[4]),
+						atoi(argv[6]), atoi(argv[5]), atoi(argv[7]));
+			} catch (exception & e) {
+				cout << "There was an error opening the files..." << endl;
+				return 1;
+			}
+			cout << "END" << endl;
+			return 0;
+		}
+
+	if (strcmp(argv[1], "batch") == 0) {
+		string algoritmo = argv[3];
+		if (algoritmo != "A*" && algoritmo != "Dijkstra") {
+			cout << "There is no such Algorithm." << endl;
+			return 3;
+		}
+		vector<RouteQuery> pedidos;
+		try {
+			pedidos = readRouteQueries(argv[2]);
+		} catch (exception & e) {
+			cout << "There was an error opening the files..." << endl;
+			return 1;
+		}
+
+		//grafo sem GraphViewer
+		string ficheiro = argv[8];
+		Graph<NoInfo> data;
+		NodeIdMap ids;
+		GraphViewer * gv = NULL;
+		struct cantos corners;
+		corners.minLong = atof(argv[11]);
+		corners.minLat = atof(argv[12]);
+		corners.maxLong = atof(argv[13]);
+		corners.maxLat = atof(argv[14]);
+		abrirMapa(ficheiro, snapshot, data, gv, corners, atoi(argv[9]),
+				atoi(argv[10]), &ids);
+		resolveRouteQueries(pedidos, ids);
+		gera_linhas(data, atoi(argv[4]), atoi(argv[6]), atoi(argv[5]),
+				atoi(argv[7]));
+		//vizinhos no mapa ficam perto na memoria, paga-se uma vez para todos os pedidos
+		FrozenGraph<NoInfo> ficheiro_ordem = data.freeze();
+		FrozenGraph<NoInfo> rotas = ficheiro_ordem.permuted(
+				hilbertOrder(ficheiro_ordem));
+
+		unsigned int maxThreads = thread::hardware_concurrency();
+		if (maxThreads == 0)
+			maxThreads = 1;
+		cout << pedidos.size() << " pedidos, " << rotas.getNumVertex()
+				<< " nos" << endl;
+		vector<RouteResult> resultados = testBatchThroughput(rotas, pedidos,
+				algoritmo, maxThreads);
+
+		string saida = argv[2];
+		size_t ponto = saida.find_last_of('.');
+		size_t barra = saida.find_last_of("/\\");
+		if (ponto != string::npos && (barra == string::npos || ponto > barra))
+			saida = saida.substr(0, ponto);
+		saida += "_resultados.txt";
+		try {
+			writeRouteResults(saida, pedidos, resultados, ids);
+		} catch (exception & e) {
+			cout << "There was an error writing the results..." << endl;
+			return 1;
+		}
+		cout << "Resultados em " << saida << endl;
+		cout << "END" << endl;
+		return 0;
+	}
+
 	string ficheiro = argv[8];
 	Graph<NoInfo> data;
 	int xMaxW = atoi(argv[9]);
@@ -308,8 +415,8 @@ int main(int argc, char * argv[]) {
 	corners.maxLong = atof(argv[13]);
 	corners.maxLat = atof(argv[14]);
 
-	abrirFicheiroXY(ficheiro + "_a.txt", ficheiro + "_b.txt",
-			ficheiro + "_c.txt", data, gv, corners, xMaxW, yMaxW);
+	NodeIdMap ids;
+	abrirMapa(ficheiro, snapshot, data, gv, corners, xMaxW, yMaxW, &ids);
 
 	int linhas_metro = atoi(argv[4]);
 	int linhas_autocarro = atoi(argv[6]);
@@ -333,20 +440,20 @@ int main(int argc, char * argv[]) {
 		return 0;
 	} else if (strcmp(argv[1], "Connectivity") == 0) {
 		vector<int> soma;
-		vector<Vertex<NoInfo>*> vertices = data.getVertexSet();
-		for (unsigned int i = 0; i < vertices.size(); i++) {
-			vector<NoInfo> tentativa = data.bfs(vertices[i]);
-			soma.push_back(vertices.size() - tentativa.size());
+		FrozenGraph<NoInfo> rotas = data.freeze();
+		for (unsigned int i = 0; i < rotas.getNumVertex(); i++) {
+			vector<unsigned int> tentativa = rotas.bfs(i);
+			soma.push_back(rotas.getNumVertex() - tentativa.size());
 		}
 		int max_falha = 0;
-		int min_falha = vertices.size();
+		int min_falha = rotas.getNumVertex();
 		for (int ind : soma) {
 			if (ind < min_falha)
 				min_falha = ind;
 			if (ind > max_falha)
 				max_falha = ind;
 		}
-		cout << "Em " << vertices.size() << " nos, o minimo de falhas foi "
+		cout << "Em " << rotas.getNumVertex() << " nos, o minimo de falhas foi "
 				<< min_falha << endl;
 		cout << "O maximo foi " << max_falha << endl;
 		cout << "END" << endl;
@@ -574,26 +681,99 @@ int main(int argc, char * argv[]) {
 	} else { //no inicio para o fim
 		linhas_geradas = gera_linhas(data, linhas_metro, linhas_autocarro,
 				comp_metro, comp_autocarro);
-		Vertex<NoInfo> * origem = data.getVertex(
-				NoInfo(atoi(argv[1]), 0, 0, ' '));
-		Vertex<NoInfo> * destino = data.getVertex(
-				NoInfo(atoi(argv[2]), 0, 0, ' '));
+		FrozenGraph<NoInfo> rotas = data.freeze();
+		Vertex<NoInfo> * origem = NULL;
+		Vertex<NoInfo> * destino = NULL;
+		if (strcmp(argv[1], "coords") == 0) {
+			vector<long double> graus;
+			stringstream lista(argv[2]);
+			string valor;
+			while (getline(lista, valor, ','))
+				graus.push_back(atof(valor.c_str()));
+			if (graus.size() != 4) {
+				cout << "There was an input error, please contact the developers."
+						<< endl;
+				return 1;
+			}
+			//cada ponto vai para o no a pe mais perto
+			SpatialIndex<NoInfo> indice(rotas);
+			for (unsigned int i = 0; i < 2; i++) {
+				vector<NearbyVertex> perto = indice.nearest(
+						graus[2 * i] * M_PI / 180, graus[2 * i + 1] * M_PI / 180, 1);
+				if (perto.empty())
+					break;
+				const NoInfo &info = rotas.getInfo(perto[0].vertice);
+				cout << (i == 0 ? "ORIGEM" : "DESTINO") << " : no "
+						<< ids.getOriginalId(info.idNo) << " a "
+						<< perto[0].km * 1000 << "m" << endl;
+				(i == 0 ? origem : destino) = data.getVertex(info);
+			}
+		} else {
+			origem = data.getVertex(
+					NoInfo(ids.find(strtoull(argv[1], NULL, 10)), 0, 0, ' '));
+			destino = data.getVertex(
+					NoInfo(ids.find(strtoull(argv[2], NULL, 10)), 0, 0, ' '));
+		}
 		if (origem == NULL || destino == NULL) {
 			cout << "There is no such path" << endl;
 			return 2;
 		}
 		vector<NoInfo> caminho;
+		SearchWorkspace<float> ws;
 		if (strcmp(argv[3], "A*") == 0) {
-			preparaA_star(data, destino->getInfo());
-			caminho = data.getA_starPath(origem->getInfo(), destino->getInfo());
+			GeoPoints pontos(rotas);
+			caminho = rotas.getA_starPath(origem->getInfo(), destino->getInfo(),
+					haversineHeuristic(pontos, destino->getInfo()), ws);
+
+		} else if (strcmp(argv[3], "ALT") == 0) {
+			Landmarks<NoInfo> alt(rotas);
+			caminho = rotas.getA_starPath(origem->getInfo(), destino->getInfo(),
+					landmarkHeuristic<NoInfo>(alt,
+							rotas.getIndex(destino->getInfo())), ws);
 
 		} else if (strcmp(argv[3], "Dijkstra") == 0) {
-			caminho = data.getDijkstraPath(origem->getInfo(),
-					destino->getInfo());
+			caminho = rotas.getDijkstraPath(origem->getInfo(),
+					destino->getInfo(), ws);
+
+		} else if (strcmp(argv[3], "Radix") == 0) {
+			SearchWorkspace<unsigned int> wsInteiro;
+			RadixHeap q;
+			rotas.quantize();
+			caminho = rotas.getRadixDijkstraPath(origem->getInfo(),
+					destino->getInfo(), wsInteiro, q);
+		} else if (strcmp(argv[3], "BiDijkstra") == 0) {
+			SearchWorkspace<float> wsTras;
+			caminho = rotas.getBidirectionalDijkstraPath(origem->getInfo(),
+					destino->getInfo(), ws, wsTras);
+
+		} else if (strcmp(argv[3], "BiA*") == 0) {
+			SearchWorkspace<float> wsTras;
+			GeoPoints pontos(rotas);
+			caminho = rotas.getBidirectionalA_starPath(origem->getInfo(),
+					destino->getInfo(),
+					haversineHeuristic(pontos, destino->getInfo()),
+					haversineHeuristic(pontos, origem->getInfo()), ws, wsTras);
 
 		} else if (strcmp(argv[3], "Floyd-Warshall") == 0) {
 			caminho = data.getfloydWarshallPath(origem->getInfo(),
 					destino->getInfo());
+		} else if (strcmp(argv[3], "CH") == 0) {
+			ContractionHierarchy<NoInfo> hierarquia(rotas);
+			SearchWorkspace<float> wsTras;
+			caminho = hierarquia.getCHPath(origem->getInfo(),
+					destino->getInfo(), ws, wsTras);
+		} else if (strcmp(argv[3], "HL") == 0) {
+			ContractionHierarchy<NoInfo> hierarquia(rotas);
+			HubLabels<NoInfo> labels(rotas, hierarquia);
+			caminho = labels.getHubLabelPath(origem->getInfo(),
+					destino->getInfo());
+		} else if (strcmp(argv[3], "CRP") == 0) {
+			MultilevelOverlay<NoInfo> overlay(rotas);
+			ThreadPool pool(thread::hardware_concurrency());
+			overlay.customize(transportWeights(rotas), pool);
+			SearchWorkspace<float> wsLocal;
+			caminho = overlay.getOverlayPath(origem->getInfo(),
+					destino->getInfo(), ws, wsLocal);
 		} else {
 			cout << "There is no such Algorithm." << endl;
 			return 3;
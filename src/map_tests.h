@@ -12,6 +12,13 @@
 #include "Graph.h"
 #include "graphviewer.h"
 #include "file_reading.h"
+#include "ContractionHierarchy.h"
+#include "Landmarks.h"
+#include "HubLabels.h"
+#include "MultilevelOverlay.h"
+#include "DeltaStepping.h"
+#include "PerfCounters.h"
+#include "VertexOrder.h"
 #include <chrono>
 
 #define VELOCIDADE_PE 5 //km/h
@@ -130,6 +137,7 @@ static void testFloidWarshal_big(Graph<NoInfo>& data, GraphViewer*& gv,
 		int num) {
 	//teste floyd warshal bigger
 	int i = 0;
+	SearchWorkspace<long double> ws;
 
 	while (i < num) {
 		int ind0 = rand() % data.getVertexSet().size();
@@ -142,7 +150,7 @@ static void testFloidWarshal_big(Graph<NoInfo>& data, GraphViewer*& gv,
 			continue;
 
 		vector<NoInfo> path = data.getDijkstraPath(ori->getInfo(),
-				des->getInfo());
+				des->getInfo(), ws);
 
 		if (path.size() < 50)
 			continue;
@@ -188,6 +196,45 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 	int i = 0;
 	double mediaAstar = 0;
 	double mediaDijkstra = 0;
+	double mediaDijkstraMakeHeap = 0;
+	double mediaAstarCSR = 0;
+	double mediaDijkstraCSR = 0;
+	double mediaCH = 0;
+	double mediaALT = 0;
+	double mediaBiDijkstra = 0;
+	double mediaBiAstar = 0;
+	double exploradosDijkstraCSR = 0;
+	double exploradosBiDijkstra = 0;
+	double exploradosBiAstar = 0;
+	double exploradosAstarCSR = 0;
+	double exploradosALT = 0;
+	double mediaRadix = 0;
+	double erroRadix = 0;
+	FrozenGraph<NoInfo> rotas = data.freeze();
+	rotas.quantize();
+	GeoPoints pontos(rotas); //os indices do snapshot sao os do grafo
+	SearchWorkspace<long double> ws;
+	SearchWorkspace<float> wsCSR;
+	SearchWorkspace<float> wsTras;
+	SearchWorkspace<unsigned int> wsInteiro;
+	RadixHeap radix;
+
+	auto ch_start = std::chrono::high_resolution_clock::now();
+	ContractionHierarchy<NoInfo> hierarquia(rotas);
+	auto ch_end = std::chrono::high_resolution_clock::now();
+	cout << "PRE-PROCESSAMENTO CH : "
+			<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+					ch_end - ch_start).count() << " ("
+			<< hierarquia.getNumShortcuts() << " atalhos)" << endl;
+
+	auto alt_start = std::chrono::high_resolution_clock::now();
+	Landmarks<NoInfo> alt(rotas);
+	auto alt_end = std::chrono::high_resolution_clock::now();
+	cout << "PRE-PROCESSAMENTO ALT : "
+			<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+					alt_end - alt_start).count() << " ("
+			<< alt.getNumLandmarks() << " landmarks)" << endl;
+
 	while (i < NUM_CAMINHOS) {
 		int ind0 = rand() % data.getVertexSet().size();
 		int ind1 = rand() % data.getVertexSet().size();
@@ -200,7 +247,7 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 
 
 		vector<NoInfo> teste = data.getDijkstraPath(ori->getInfo(),
-				des->getInfo());
+				des->getInfo(), ws);
 
 		if (teste.size() < 2)
 			continue;
@@ -210,10 +257,11 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 		vector<NoInfo> pathA;
 
 
-		preparaA_star(data, des->getInfo());
+		heuristicFunc<NoInfo> heuristica(pontos, des->getInfo());
 		auto startA_star = std::chrono::high_resolution_clock::now();
 		for (unsigned int i = 0; i < REP_FOR; i++) {
-			pathA = data.getA_starPath(ori->getInfo(), des->getInfo());
+			pathA = data.getA_starPath(ori->getInfo(), des->getInfo(), heuristica,
+					ws);
 		}
 		auto endA_star = std::chrono::high_resolution_clock::now();
 		cout
@@ -228,7 +276,7 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 		auto dijkstra_start = std::chrono::high_resolution_clock::now();
 		for (unsigned int i = 0; i < REP_FOR; i++) {
 			vector<NoInfo> pathD = data.getDijkstraPath(ori->getInfo(),
-					des->getInfo());
+					des->getInfo(), ws);
 		}
 		auto dijkstra_end = std::chrono::high_resolution_clock::now();
 		cout
@@ -237,6 +285,135 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 
 		mediaDijkstra += (double) std::chrono::duration_cast<std::chrono::microseconds>(
 				dijkstra_end - dijkstra_start).count();
+
+		cout << "Dijkstra (make_heap) " << i + 1 << ":" << endl;
+		auto makeheap_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathD = data.getDijkstraPathMakeHeap(ori->getInfo(),
+					des->getInfo(), ws);
+		}
+		auto makeheap_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						makeheap_end - makeheap_start).count() << endl;
+
+		mediaDijkstraMakeHeap += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				makeheap_end - makeheap_start).count();
+
+		cout << "A* (CSR) " << i + 1 << ":" << endl;
+		auto astar_csr_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathC = rotas.getA_starPath(ori->getInfo(),
+					des->getInfo(), haversineHeuristic(pontos, des->getInfo()),
+					wsCSR);
+		}
+		auto astar_csr_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						astar_csr_end - astar_csr_start).count() << endl;
+
+		mediaAstarCSR += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				astar_csr_end - astar_csr_start).count();
+		exploradosAstarCSR += wsCSR.getNumSettled();
+
+		cout << "A* (ALT) " << i + 1 << ":" << endl;
+		auto alt_query_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathL = rotas.getA_starPath(ori->getInfo(),
+					des->getInfo(),
+					landmarkHeuristic<NoInfo>(alt, rotas.getIndex(des->getInfo())),
+					wsCSR);
+		}
+		auto alt_query_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						alt_query_end - alt_query_start).count() << endl;
+
+		mediaALT += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				alt_query_end - alt_query_start).count();
+		exploradosALT += wsCSR.getNumSettled();
+
+		cout << "Dijkstra (CSR) " << i + 1 << ":" << endl;
+		auto dijkstra_csr_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathC = rotas.getDijkstraPath(ori->getInfo(),
+					des->getInfo(), wsCSR);
+		}
+		auto dijkstra_csr_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						dijkstra_csr_end - dijkstra_csr_start).count() << endl;
+
+		mediaDijkstraCSR += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				dijkstra_csr_end - dijkstra_csr_start).count();
+		exploradosDijkstraCSR += wsCSR.getNumSettled();
+
+		cout << "Dijkstra (radix heap) " << i + 1 << ":" << endl;
+		auto radix_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathR = rotas.getRadixDijkstraPath(ori->getInfo(),
+					des->getInfo(), wsInteiro, radix);
+		}
+		auto radix_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						radix_end - radix_start).count() << endl;
+
+		mediaRadix += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				radix_end - radix_start).count();
+		//diferenca (em segundos) para a distancia em float do dijkstra anterior
+		unsigned int destinoCSR = rotas.getIndex(des->getInfo());
+		double erro = fabs(
+				(double) wsInteiro.getDist(destinoCSR) / rotas.getUnitsPerHour()
+						- wsCSR.getDist(destinoCSR)) * 3600;
+		if (erro > erroRadix)
+			erroRadix = erro;
+
+		cout << "Dijkstra bidirecional " << i + 1 << ":" << endl;
+		auto bidijkstra_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathB = rotas.getBidirectionalDijkstraPath(
+					ori->getInfo(), des->getInfo(), wsCSR, wsTras);
+		}
+		auto bidijkstra_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						bidijkstra_end - bidijkstra_start).count() << endl;
+
+		mediaBiDijkstra += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				bidijkstra_end - bidijkstra_start).count();
+		exploradosBiDijkstra += wsCSR.getNumSettled() + wsTras.getNumSettled();
+
+		cout << "A* bidirecional " << i + 1 << ":" << endl;
+		auto biastar_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathB = rotas.getBidirectionalA_starPath(
+					ori->getInfo(), des->getInfo(),
+					haversineHeuristic(pontos, des->getInfo()),
+					haversineHeuristic(pontos, ori->getInfo()), wsCSR, wsTras);
+		}
+		auto biastar_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						biastar_end - biastar_start).count() << endl;
+
+		mediaBiAstar += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				biastar_end - biastar_start).count();
+		exploradosBiAstar += wsCSR.getNumSettled() + wsTras.getNumSettled();
+
+		cout << "CH " << i + 1 << ":" << endl;
+		auto ch_query_start = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < REP_FOR; i++) {
+			vector<NoInfo> pathH = hierarquia.getCHPath(ori->getInfo(),
+					des->getInfo(), wsCSR, wsTras);
+		}
+		auto ch_query_end = std::chrono::high_resolution_clock::now();
+		cout
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						ch_query_end - ch_query_start).count() << endl;
+
+		mediaCH += (double) std::chrono::duration_cast<std::chrono::microseconds>(
+				ch_query_end - ch_query_start).count();
 		string color = "BLACK";
 		switch (i) {
 		case 0:
@@ -274,9 +451,621 @@ static void testExecutionTimes(Graph<NoInfo>& data, GraphViewer*& gv) {
 
 	mediaAstar /= (NUM_CAMINHOS*REP_FOR);
 	mediaDijkstra /= (NUM_CAMINHOS*REP_FOR);
+	mediaDijkstraMakeHeap /= (NUM_CAMINHOS*REP_FOR);
+	mediaAstarCSR /= (NUM_CAMINHOS*REP_FOR);
+	mediaDijkstraCSR /= (NUM_CAMINHOS*REP_FOR);
+	mediaRadix /= (NUM_CAMINHOS*REP_FOR);
+	mediaCH /= (NUM_CAMINHOS*REP_FOR);
+	mediaALT /= (NUM_CAMINHOS*REP_FOR);
+	exploradosAstarCSR /= NUM_CAMINHOS;
+	exploradosALT /= NUM_CAMINHOS;
+	mediaBiDijkstra /= (NUM_CAMINHOS*REP_FOR);
+	mediaBiAstar /= (NUM_CAMINHOS*REP_FOR);
+	exploradosDijkstraCSR /= NUM_CAMINHOS;
+	exploradosBiDijkstra /= NUM_CAMINHOS;
+	exploradosBiAstar /= NUM_CAMINHOS;
 
 	cout << "MEDIA A* : " << mediaAstar << endl;
 	cout << "MEDIA DIJKSTRA : " << mediaDijkstra << endl;
+	cout << "MEDIA DIJKSTRA (make_heap) : " << mediaDijkstraMakeHeap << endl;
+	cout << "MEDIA A* (CSR) : " << mediaAstarCSR << endl;
+	cout << "MEDIA DIJKSTRA (CSR) : " << mediaDijkstraCSR << endl;
+	cout << "MEDIA DIJKSTRA (radix heap) : " << mediaRadix << endl;
+	cout << "ERRO MAXIMO DOS PESOS INTEIROS : " << erroRadix << "s" << endl;
+	cout << "MEDIA CH : " << mediaCH << endl;
+	cout << "MEDIA A* (ALT) : " << mediaALT << endl;
+	cout << "VERTICES EXPLORADOS A* (CSR) : " << exploradosAstarCSR << endl;
+	cout << "VERTICES EXPLORADOS A* (ALT) : " << exploradosALT << endl;
+	cout << "MEDIA DIJKSTRA BIDIRECIONAL : " << mediaBiDijkstra << endl;
+	cout << "MEDIA A* BIDIRECIONAL : " << mediaBiAstar << endl;
+	cout << "VERTICES EXPLORADOS DIJKSTRA (CSR) : " << exploradosDijkstraCSR << endl;
+	cout << "VERTICES EXPLORADOS DIJKSTRA BIDIRECIONAL : " << exploradosBiDijkstra << endl;
+	cout << "VERTICES EXPLORADOS A* BIDIRECIONAL : " << exploradosBiAstar << endl;
  }
 
+/**
+ * @brief Tests map loading times (called when the main function receives "load" as the first parameter).
+ * The maps are loaded without a GraphViewer, so only the graph construction is measured. The time per edge
+ * should stay roughly constant from the smallest to the biggest map. Also reports the memory of the graph
+ * (its arena and the growth of the resident set, where the system gives it), the time to destroy it and
+ * the parsing speed of each file type. Then saves the graph in a binary snapshot (see MapSnapshot.h),
+ * loads it back, checks that the two graphs are the same and that the snapshot is refused for another map,
+ * and compares the load times.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testLoadTimes(const vector<string>& radicais) {
+	struct cantos corners;
+	corners.minLong = 0;
+	corners.minLat = 0;
+	corners.maxLong = 1;
+	corners.maxLat = 1;
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		size_t rssAntes = residentSetBytes();
+		Graph<NoInfo> *data = new Graph<NoInfo>();
+		GraphViewer * gv = NULL;
+
+		LoadStats stats;
+		MapStreets ruas;
+		NodeIdMap ids;
+		auto start = std::chrono::high_resolution_clock::now();
+		abrirFicheiroXY(radicais[i] + "_a.txt", radicais[i] + "_b.txt",
+				radicais[i] + "_c.txt", *data, gv, corners, 1, 1, &stats, &ruas,
+				&ids);
+		auto end = std::chrono::high_resolution_clock::now();
+		size_t rssDepois = residentSetBytes();
+
+		double micros =
+				(double) std::chrono::duration_cast<std::chrono::microseconds>(
+						end - start).count();
+		cout << radicais[i] << ": " << data->getNumVertex() << " nos, "
+				<< data->getNumEdges() << " arestas" << endl;
+		cout << "TEMPO DE CARREGAMENTO : " << micros / 1000 << "ms" << endl;
+		if (data->getNumEdges() > 0)
+			cout << "POR ARESTA : " << micros * 1000 / data->getNumEdges()
+					<< "ns" << endl;
+		const char *tipos[] = { "_a", "_b", "_c" };
+		for (unsigned int f = 0; f < 3; f++)
+			cout << "LEITURA " << tipos[f] << " : " << stats.bytes[f] / 1024
+					<< "KB, "
+					<< (stats.parseSeconds[f] > 0 ?
+							stats.bytes[f] / stats.parseSeconds[f] / 1e6 : 0)
+					<< "MB/s" << endl;
+		cout << "CONSTRUCAO DO GRAFO : " << stats.graphSeconds * 1000 << "ms ("
+				<< stats.repeatedNodes << " nos e " << stats.duplicateEdges
+				<< " arestas repetidas)" << endl;
+		cout << "ARENA : " << data->getArena().getReservedBytes() / 1024 << "KB em "
+				<< data->getArena().getNumBlocks() << " blocos" << endl;
+		if (rssDepois > 0)
+			cout << "RSS : " << rssDepois / 1024 << "KB (+"
+					<< (rssDepois > rssAntes ? rssDepois - rssAntes : 0) / 1024
+					<< "KB)" << endl;
+		else
+			cout << "RSS : n/d" << endl;
+
+		string snapshot = radicais[i] + "_snapshot.bin";
+		start = std::chrono::high_resolution_clock::now();
+		writeSnapshot(snapshot, radicais[i], *data, ruas, ids);
+		auto escrito = std::chrono::high_resolution_clock::now();
+		Graph<NoInfo> copia;
+		GraphSnapshot mapa(snapshot, radicais[i]);
+		NodeIdMap idsLidos;
+		mapa.toGraph(copia, &idsLidos);
+		end = std::chrono::high_resolution_clock::now();
+		double microsSnapshot = (double) std::chrono::duration_cast<
+				std::chrono::microseconds>(end - escrito).count();
+		cout << "SNAPSHOT : " << mapa.getFileBytes() / 1024 << "KB, escrita "
+				<< (double) std::chrono::duration_cast<
+						std::chrono::microseconds>(escrito - start).count() / 1000
+				<< "ms, leitura " << microsSnapshot / 1000 << "ms ("
+				<< micros / microsSnapshot << "x)" << endl;
+
+		FrozenGraph<NoInfo> original = data->freeze();
+		FrozenGraph<NoInfo> lido = copia.freeze();
+		bool igual = original.getNumVertex() == lido.getNumVertex()
+				&& original.getNumEdges() == lido.getNumEdges();
+		for (unsigned int v = 0; igual && v < original.getNumVertex(); v++)
+			igual = original.getInfo(v) == lido.getInfo(v)
+					&& original.getInfo(v).latitude == lido.getInfo(v).latitude
+					&& original.getInfo(v).longitude == lido.getInfo(v).longitude
+					&& original.edgesEnd(v) == lido.edgesEnd(v)
+					&& ids.getOriginalId(original.getInfo(v).idNo)
+							== idsLidos.getOriginalId(lido.getInfo(v).idNo);
+		for (unsigned int e = 0; igual && e < original.getNumEdges(); e++)
+			igual = original.getTarget(e) == lido.getTarget(e)
+					&& original.getWeight(e) == lido.getWeight(e)
+					&& original.getEdgeId(e) == lido.getEdgeId(e);
+		cout << "SNAPSHOT IGUAL AO GRAFO : " << (igual ? "sim" : "nao") << endl;
+		bool recusado = false;
+		try {
+			GraphSnapshot outro(snapshot, radicais[i] + "_outro");
+		} catch (runtime_error & e) {
+			recusado = true;
+		}
+		cout << "SNAPSHOT RECUSADO PARA OUTRO MAPA : " << (recusado ? "sim" : "nao")
+				<< endl;
+		remove(snapshot.c_str());
+
+		start = std::chrono::high_resolution_clock::now();
+		delete data;
+		end = std::chrono::high_resolution_clock::now();
+		cout << "TEMPO DE DESTRUICAO : "
+				<< (double) std::chrono::duration_cast<
+						std::chrono::microseconds>(end - start).count() / 1000
+				<< "ms" << endl;
+	}
+}
+
+/**
+ * @brief Loads a map for the tests over many maps, with no GraphViewer, adds the generated subway and bus lines
+ * and compiles its routing snapshot, printing its size.
+ * @param radical the filename radical of the map (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ * @param data output, the graph of the map
+ * @param rotas output, the routing snapshot of data
+ * @return false if the map has no vertices (nothing to test)
+ */
+static bool carregaRotas(const string &radical, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro,
+		Graph<NoInfo> &data, FrozenGraph<NoInfo> &rotas) {
+	struct cantos corners;
+	corners.minLong = 0;
+	corners.minLat = 0;
+	corners.maxLong = 1;
+	corners.maxLat = 1;
+	GraphViewer * gv = NULL;
+	abrirFicheiroXY(radical + "_a.txt", radical + "_b.txt", radical + "_c.txt",
+			data, gv, corners, 1, 1);
+	gera_linhas(data, linhas_metro, linhas_autocarro, comp_metro,
+			comp_autocarro);
+	rotas = data.freeze();
+	cout << radical << ": " << rotas.getNumVertex() << " nos, "
+			<< rotas.getNumEdges() << " arestas" << endl;
+	return rotas.getNumVertex() > 0;
+}
+
+/**
+ * @brief Tests the hub labeling index (called when the main function receives "labels" as the first parameter).
+ * For each map it reports the preprocessing time and the memory taken by the labels, and compares
+ * NUM_CAMINHOS random queries answered by getDijkstraPath and by the labels (distance only and full path).
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testHubLabels(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		FrozenGraph<NoInfo> rotas;
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, rotas))
+			continue;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		ContractionHierarchy<NoInfo> hierarquia(rotas);
+		HubLabels<NoInfo> labels(rotas, hierarquia);
+		auto end = std::chrono::high_resolution_clock::now();
+		cout << "PRE-PROCESSAMENTO (CH + LABELS) : "
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						end - start).count() / 1000 << "ms" << endl;
+		cout << "ENTRADAS : " << labels.getNumEntries() << " ("
+				<< (double) labels.getNumEntries() / rotas.getNumVertex()
+				<< " por no)" << endl;
+		cout << "MEMORIA : " << (double) labels.getMemoryBytes() / (1024 * 1024)
+				<< "MB" << endl;
+
+		SearchWorkspace<long double> ws;
+		double mediaDijkstra = 0, mediaDistancia = 0, mediaCaminho = 0;
+		int diferencas = 0;
+		for (int j = 0; j < NUM_CAMINHOS; j++) {
+			unsigned int s = rand() % rotas.getNumVertex();
+			unsigned int t = rand() % rotas.getNumVertex();
+			const NoInfo &origem = rotas.getInfo(s);
+			const NoInfo &destino = rotas.getInfo(t);
+
+			auto dijkstra_start = std::chrono::high_resolution_clock::now();
+			vector<NoInfo> pathD = data.getDijkstraPath(origem, destino, ws);
+			auto dijkstra_end = std::chrono::high_resolution_clock::now();
+			float distancia = labels.query(s, t);
+			auto distancia_end = std::chrono::high_resolution_clock::now();
+			vector<NoInfo> pathH = labels.getHubLabelPath(origem, destino);
+			auto caminho_end = std::chrono::high_resolution_clock::now();
+
+			mediaDijkstra += (double) std::chrono::duration_cast<
+					std::chrono::nanoseconds>(dijkstra_end - dijkstra_start).count();
+			mediaDistancia += (double) std::chrono::duration_cast<
+					std::chrono::nanoseconds>(distancia_end - dijkstra_end).count();
+			mediaCaminho += (double) std::chrono::duration_cast<
+					std::chrono::nanoseconds>(caminho_end - distancia_end).count();
+
+			long double esperada = ws.getDist(data.getVertex(destino)->getIndex());
+			if (std::isinf(esperada) != std::isinf(distancia)
+					|| (!std::isinf(esperada)
+							&& fabsl(esperada - distancia) > 1e-4 * esperada)
+					|| (!std::isinf(distancia) && pathH.empty()))
+				diferencas++;
+		}
+		cout << "MEDIA DIJKSTRA : " << mediaDijkstra / NUM_CAMINHOS / 1000
+				<< "us" << endl;
+		cout << "MEDIA LABELS (distancia) : "
+				<< mediaDistancia / NUM_CAMINHOS / 1000 << "us" << endl;
+		cout << "MEDIA LABELS (caminho) : " << mediaCaminho / NUM_CAMINHOS / 1000
+				<< "us" << endl;
+		cout << "DIFERENCAS : " << diferencas << endl;
+	}
+}
+
+/**
+ * @brief Tests the multilevel overlay (called when the main function receives "overlay" as the first parameter).
+ * For each map it reports the time of the partition (done once) and of the customization with the speeds
+ * used to load the map, and compares NUM_CAMINHOS random queries with Dijkstra. Then it customizes again
+ * with the speeds and waiting times of todos_transportes, without a new partition, and compares the
+ * queries with a plain Dijkstra over the new weights.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testCustomization(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+	ThreadPool pool(thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		FrozenGraph<NoInfo> rotas;
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, rotas))
+			continue;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		MultilevelOverlay<NoInfo> overlay(rotas);
+		transportWeights pesos(rotas);
+		auto end = std::chrono::high_resolution_clock::now();
+		cout << "PARTICAO : "
+				<< (double) std::chrono::duration_cast<std::chrono::microseconds>(
+						end - start).count() / 1000 << "ms" << endl;
+		for (unsigned int l = 1; l <= CRP_NIVEIS; l++)
+			cout << "NIVEL " << l << " : " << overlay.getNumCells(l)
+					<< " celulas, " << overlay.getNumBoundary(l)
+					<< " vertices de fronteira" << endl;
+
+		SearchWorkspace<float> ws, wsReferencia;
+		for (int metrica = 0; metrica < 2; metrica++) {
+			if (metrica == 1)
+				pesos.setTransportes(todos_transportes);
+			start = std::chrono::high_resolution_clock::now();
+			overlay.customize(pesos, pool);
+			end = std::chrono::high_resolution_clock::now();
+			cout << (metrica == 0 ? "CUSTOMIZACAO : " : "NOVA CUSTOMIZACAO : ")
+					<< (double) std::chrono::duration_cast<
+							std::chrono::microseconds>(end - start).count() / 1000
+					<< "ms" << endl;
+			cout << "MEMORIA : " << (double) overlay.getMemoryBytes() / (1024 * 1024)
+					<< "MB" << endl;
+
+			double mediaOverlay = 0, mediaDijkstra = 0;
+			int diferencas = 0;
+			for (int j = 0; j < NUM_CAMINHOS; j++) {
+				unsigned int s = rand() % rotas.getNumVertex();
+				unsigned int t = rand() % rotas.getNumVertex();
+
+				auto overlay_start = std::chrono::high_resolution_clock::now();
+				float distancia = overlay.query(s, t, ws);
+				auto overlay_end = std::chrono::high_resolution_clock::now();
+				float esperada =
+						metrica == 0 ?
+								rotas.dijkstra(s, t, wsReferencia) :
+								overlay.query(s, t, wsReferencia, false);
+				auto dijkstra_end = std::chrono::high_resolution_clock::now();
+
+				mediaOverlay += (double) std::chrono::duration_cast<
+						std::chrono::nanoseconds>(overlay_end - overlay_start).count();
+				mediaDijkstra += (double) std::chrono::duration_cast<
+						std::chrono::nanoseconds>(dijkstra_end - overlay_end).count();
+				if (std::isinf(esperada) != std::isinf(distancia)
+						|| (!std::isinf(esperada)
+								&& fabs(esperada - distancia) > 1e-4 * esperada))
+					diferencas++;
+			}
+			cout << "MEDIA OVERLAY : " << mediaOverlay / NUM_CAMINHOS / 1000
+					<< "us" << endl;
+			cout << "MEDIA DIJKSTRA : " << mediaDijkstra / NUM_CAMINHOS / 1000
+					<< "us" << endl;
+			cout << "DIFERENCAS : " << diferencas << endl;
+		}
+	}
+}
+
+/**
+ * @brief Tests the one-to-all distances (called when the main function receives "sssp" as the first parameter).
+ * For each map it runs REP_FOR random sources with the sequential Dijkstra and with delta-stepping, on one
+ * thread and on all of them, and counts the vertices whose distances differ.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testOneToAll(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+	ThreadPool umaThread(1);
+	ThreadPool todas(thread::hardware_concurrency());
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		FrozenGraph<NoInfo> rotas;
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, rotas))
+			continue;
+
+		float delta = deltaSteppingWidth(rotas);
+		cout << "DELTA : " << delta << endl;
+
+		SearchWorkspace<float> ws;
+		vector<float> dist;
+		double mediaDijkstra = 0, mediaUma = 0, mediaTodas = 0;
+		int diferencas = 0;
+		for (int j = 0; j < REP_FOR; j++) {
+			unsigned int s = rand() % rotas.getNumVertex();
+
+			auto start = std::chrono::high_resolution_clock::now();
+			rotas.dijkstra(s, FrozenGraph<NoInfo>::NO_VERTEX, ws);
+			auto dijkstra_end = std::chrono::high_resolution_clock::now();
+			deltaStepping(rotas, s, delta, umaThread, dist);
+			auto uma_end = std::chrono::high_resolution_clock::now();
+			deltaStepping(rotas, s, delta, todas, dist);
+			auto todas_end = std::chrono::high_resolution_clock::now();
+
+			mediaDijkstra += (double) std::chrono::duration_cast<
+					std::chrono::microseconds>(dijkstra_end - start).count();
+			mediaUma += (double) std::chrono::duration_cast<
+					std::chrono::microseconds>(uma_end - dijkstra_end).count();
+			mediaTodas += (double) std::chrono::duration_cast<
+					std::chrono::microseconds>(todas_end - uma_end).count();
+			for (unsigned int v = 0; v < rotas.getNumVertex(); v++)
+				if (dist[v] != ws.getDist(v))
+					diferencas++;
+		}
+		cout << "MEDIA DIJKSTRA : " << mediaDijkstra / REP_FOR / 1000 << "ms"
+				<< endl;
+		cout << "MEDIA DELTA-STEPPING (1 thread) : " << mediaUma / REP_FOR / 1000
+				<< "ms" << endl;
+		cout << "MEDIA DELTA-STEPPING (" << todas.size() << " threads) : "
+				<< mediaTodas / REP_FOR / 1000 << "ms" << endl;
+		cout << "DIFERENCAS : " << diferencas << endl;
+	}
+}
+
+/**
+ * @brief Compares the memory layout of Graph and of its CSR snapshot (called when the main function receives
+ * "layout" as the first parameter). For each map it reports the bytes per vertex of each one and the time and
+ * cache misses (where the hardware counters are available, see CacheMissCounter) of NUM_CAMINHOS random
+ * Dijkstra queries over each one.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testMemoryLayout(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+	cout << "sizeof(Vertex) : " << sizeof(Vertex<NoInfo>) << ", sizeof(Edge) : "
+			<< sizeof(Edge<NoInfo>) << ", sizeof(NoInfo) : " << sizeof(NoInfo)
+			<< endl;
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		FrozenGraph<NoInfo> rotas;
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, rotas))
+			continue;
+		cout << "BYTES POR VERTICE (Graph) : "
+				<< (double) data.getMemoryBytes() / rotas.getNumVertex() << endl;
+		cout << "BYTES POR VERTICE (CSR) : "
+				<< (double) rotas.getMemoryBytes() / rotas.getNumVertex() << endl;
+
+		SearchWorkspace<long double> ws;
+		SearchWorkspace<float> wsCSR;
+		CacheMissCounter falhasGraph, falhasCSR;
+		double mediaGraph = 0, mediaCSR = 0;
+		for (int j = 0; j < NUM_CAMINHOS; j++) {
+			unsigned int s = rand() % rotas.getNumVertex();
+			unsigned int t = rand() % rotas.getNumVertex();
+
+			auto start = std::chrono::high_resolution_clock::now();
+			falhasGraph.start();
+			data.dijkstraShortestPath(rotas.getInfo(s), rotas.getInfo(t), ws);
+			falhasGraph.stop();
+			auto graph_end = std::chrono::high_resolution_clock::now();
+			falhasCSR.start();
+			rotas.dijkstra(s, t, wsCSR);
+			falhasCSR.stop();
+			auto csr_end = std::chrono::high_resolution_clock::now();
+
+			mediaGraph += (double) std::chrono::duration_cast<
+					std::chrono::nanoseconds>(graph_end - start).count();
+			mediaCSR += (double) std::chrono::duration_cast<
+					std::chrono::nanoseconds>(csr_end - graph_end).count();
+		}
+		cout << "MEDIA DIJKSTRA (Graph) : " << mediaGraph / NUM_CAMINHOS / 1000
+				<< "us" << endl;
+		cout << "MEDIA DIJKSTRA (CSR) : " << mediaCSR / NUM_CAMINHOS / 1000
+				<< "us" << endl;
+		if (falhasGraph.isAvailable()) {
+			cout << "CACHE MISSES POR PESQUISA (Graph) : "
+					<< falhasGraph.getCount() / NUM_CAMINHOS << endl;
+			cout << "CACHE MISSES POR PESQUISA (CSR) : "
+					<< falhasCSR.getCount() / NUM_CAMINHOS << endl;
+		} else
+			cout << "CACHE MISSES : n/d (sem contadores de hardware)" << endl;
+	}
+}
+
+/**
+ * @brief Compares the vertex orders of VertexOrder.h (called when the main function receives "order" as the first
+ * parameter). For each map it renumbers the routing snapshot along a Hilbert curve and by Cuthill-McKee and
+ * reports, for the order of the files and for each new one, the average edge span, and the time and cache misses
+ * (where the hardware counters are available, see CacheMissCounter) of the same NUM_CAMINHOS random Dijkstra and
+ * A* queries. The distances found must be the same in every order.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testVertexOrder(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+	const char *nomes[] = { "FICHEIRO", "HILBERT", "CUTHILL-MCKEE" };
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		vector<FrozenGraph<NoInfo> > ordens(3);
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, ordens[0]))
+			continue;
+		auto start = std::chrono::high_resolution_clock::now();
+		ordens[1] = ordens[0].permuted(hilbertOrder(ordens[0]));
+		auto hilbert_end = std::chrono::high_resolution_clock::now();
+		ordens[2] = ordens[0].permuted(cuthillMcKeeOrder(ordens[0]));
+		auto cm_end = std::chrono::high_resolution_clock::now();
+		cout << "REORDENAR : Hilbert "
+				<< (double) std::chrono::duration_cast<
+						std::chrono::microseconds>(hilbert_end - start).count() / 1000
+				<< "ms, Cuthill-McKee "
+				<< (double) std::chrono::duration_cast<
+						std::chrono::microseconds>(cm_end - hilbert_end).count() / 1000
+				<< "ms" << endl;
+
+		//os mesmos pedidos em todas as ordens, pela informacao dos vertices
+		vector<NoInfo> origens, destinos;
+		for (int j = 0; j < NUM_CAMINHOS; j++) {
+			origens.push_back(ordens[0].getInfo(rand() % ordens[0].getNumVertex()));
+			destinos.push_back(ordens[0].getInfo(rand() % ordens[0].getNumVertex()));
+		}
+		vector<float> distancias;
+		int diferencas = 0;
+		for (unsigned int o = 0; o < ordens.size(); o++) {
+			const FrozenGraph<NoInfo> &rotas = ordens[o];
+			GeoPoints pontos(rotas);
+			SearchWorkspace<float> ws;
+			CacheMissCounter falhasDijkstra, falhasAstar;
+			double mediaDijkstra = 0, mediaAstar = 0;
+			for (int j = 0; j < NUM_CAMINHOS; j++) {
+				unsigned int s = rotas.getIndex(origens[j]);
+				unsigned int t = rotas.getIndex(destinos[j]);
+
+				start = std::chrono::high_resolution_clock::now();
+				falhasDijkstra.start();
+				float d = rotas.dijkstra(s, t, ws);
+				falhasDijkstra.stop();
+				auto dijkstra_end = std::chrono::high_resolution_clock::now();
+				falhasAstar.start();
+				rotas.aStar(s, t, haversineHeuristic(pontos, destinos[j]), ws);
+				falhasAstar.stop();
+				auto astar_end = std::chrono::high_resolution_clock::now();
+
+				mediaDijkstra += (double) std::chrono::duration_cast<
+						std::chrono::nanoseconds>(dijkstra_end - start).count();
+				mediaAstar += (double) std::chrono::duration_cast<
+						std::chrono::nanoseconds>(astar_end - dijkstra_end).count();
+				if (o == 0)
+					distancias.push_back(d);
+				else if (d != distancias[j])
+					diferencas++;
+			}
+			cout << nomes[o] << " : span medio " << averageEdgeSpan(rotas)
+					<< ", Dijkstra " << mediaDijkstra / NUM_CAMINHOS / 1000
+					<< "us, A* " << mediaAstar / NUM_CAMINHOS / 1000 << "us";
+			if (falhasDijkstra.isAvailable())
+				cout << ", cache misses " << falhasDijkstra.getCount() / NUM_CAMINHOS
+						<< " / " << falhasAstar.getCount() / NUM_CAMINHOS;
+			cout << endl;
+		}
+		cout << "DIFERENCAS : " << diferencas << endl;
+	}
+}
+
+/**
+ * @brief Runs the same Dijkstra and A* queries on grafo, with the weights and queue of one combination
+ * of policies, and prints their average time and the largest relative difference of the distances
+ * found to referencia (long double, in hours).
+ */
+template<class W, class Q>
+static void testGraphPolicy(const char *nome, const Graph<NoInfo, W> &grafo,
+		const GeoPoints &pontos, const vector<NoInfo> &origens,
+		const vector<NoInfo> &destinos, const vector<long double> &referencia) {
+	SearchWorkspace<W, Q> ws;
+	double mediaDijkstra = 0, mediaAstar = 0;
+	long double erro = 0;
+	for (unsigned int j = 0; j < origens.size(); j++) {
+		unsigned int t = grafo.getVertex(destinos[j])->getIndex();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		grafo.dijkstraShortestPath(origens[j], destinos[j], ws);
+		auto dijkstra_end = std::chrono::high_resolution_clock::now();
+		W d = ws.getDist(t);
+		grafo.A_star(origens[j], destinos[j],
+				heuristicFunc<NoInfo>(pontos, destinos[j]), ws);
+		auto astar_end = std::chrono::high_resolution_clock::now();
+
+		mediaDijkstra += (double) std::chrono::duration_cast<
+				std::chrono::nanoseconds>(dijkstra_end - start).count();
+		mediaAstar += (double) std::chrono::duration_cast<
+				std::chrono::nanoseconds>(astar_end - dijkstra_end).count();
+		if (referencia[j] > 0 && ws.reached(t)) {
+			long double e[2] = { WeightTraits<W>::toHours(d), WeightTraits<W>::toHours(
+					ws.getDist(t)) };
+			for (unsigned int k = 0; k < 2; k++) {
+				e[k] = fabsl(e[k] - referencia[j]) / referencia[j];
+				if (e[k] > erro)
+					erro = e[k];
+			}
+		}
+	}
+	cout << nome << " : Dijkstra " << mediaDijkstra / origens.size() / 1000
+			<< "us, A* " << mediaAstar / origens.size() / 1000
+			<< "us, erro maximo " << (double) erro * 100 << "%" << endl;
+}
+
+/**
+ * @brief Compares the policies of Graph (called when the main function receives "policies" as the first parameter):
+ * for each map, the same NUM_CAMINHOS random Dijkstra and A* queries with weights and distances in long double, double,
+ * float and unsigned int fixed point (see WeightTraits), and with a 4-ary heap, a binary heap or a radix heap (fixed
+ * point only) as the queue. Each combination is a separate instantiation of the searches. The distances are compared to
+ * the ones of Dijkstra in long double, and the memory of the graph is reported for each weight type.
+ * @param radicais the filename radicals of the maps (e.g. "Porto" for Porto_a.txt, Porto_b.txt and Porto_c.txt)
+ */
+static void testGraphPolicies(const vector<string>& radicais, int linhas_metro,
+		int linhas_autocarro, int comp_metro, int comp_autocarro) {
+
+	for (unsigned int i = 0; i < radicais.size(); i++) {
+		Graph<NoInfo> data;
+		FrozenGraph<NoInfo> rotas;
+		if (!carregaRotas(radicais[i], linhas_metro, linhas_autocarro,
+				comp_metro, comp_autocarro, data, rotas))
+			continue;
+		Graph<NoInfo, double> dataDouble;
+		Graph<NoInfo, float> dataFloat;
+		Graph<NoInfo, unsigned int> dataFixo;
+		data.copyTo(dataDouble);
+		data.copyTo(dataFloat);
+		data.copyTo(dataFixo);
+		cout << "MEMORIA : long double " << data.getMemoryBytes() / 1024
+				<< "KB, double " << dataDouble.getMemoryBytes() / 1024
+				<< "KB, float " << dataFloat.getMemoryBytes() / 1024
+				<< "KB, ponto fixo " << dataFixo.getMemoryBytes() / 1024 << "KB"
+				<< endl;
+
+		//os mesmos pedidos em todas as combinacoes, pela informacao dos vertices
+		ArrayView<Vertex<NoInfo> *> vertices = data.getVertexSet();
+		GeoPoints pontos(data); //os indices sao os mesmos nas copias
+		vector<NoInfo> origens, destinos;
+		vector<long double> referencia;
+		SearchWorkspace<long double> ws;
+		for (int j = 0; j < NUM_CAMINHOS; j++) {
+			origens.push_back(vertices[rand() % vertices.size()]->getInfo());
+			destinos.push_back(vertices[rand() % vertices.size()]->getInfo());
+			data.dijkstraShortestPath(origens[j], destinos[j], ws);
+			unsigned int t = data.getVertex(destinos[j])->getIndex();
+			referencia.push_back(ws.reached(t) ? ws.getDist(t) : 0);
+		}
+
+		testGraphPolicy<long double, IndexedHeap<long double> >(
+				"LONG DOUBLE, HEAP 4", data, pontos, origens, destinos, referencia);
+		testGraphPolicy<double, IndexedHeap<double> >("DOUBLE, HEAP 4",
+				dataDouble, pontos, origens, destinos, referencia);
+		testGraphPolicy<float, IndexedHeap<float> >("FLOAT, HEAP 4", dataFloat,
+				pontos, origens, destinos, referencia);
+		testGraphPolicy<float, IndexedHeap<float, 2> >("FLOAT, HEAP 2",
+				dataFloat, pontos, origens, destinos, referencia);
+		testGraphPolicy<unsigned int, IndexedHeap<unsigned int> >(
+				"PONTO FIXO, HEAP 4", dataFixo, pontos, origens, destinos,
+				referencia);
+		testGraphPolicy<unsigned int, RadixHeap>("PONTO FIXO, RADIX", dataFixo,
+				pontos, origens, destinos, referencia);
+	}
+}
+
 #endif /* SRC_MAP_TESTS_H_ */
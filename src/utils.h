@@ -11,6 +11,8 @@
 #include <cmath>
 #include "NoInfo.h"
 #include "Graph.h"
+#include "FrozenGraph.h"
+#include "GeoDistance.h"
 #include "graphviewer.h"
 #include "Transporte.h"
 
@@ -56,37 +58,96 @@ vector<Transporte> todos_transportes =
 			Transporte("Metro", 2.0, 0.1, 50) };
 
 /**
- * Method to calculate the distance between two points of a spherical surface. This function applies the Haversine formula.
- * @param lat1 Latitude in radians of the first point.
- * @param long1 Longitude in radians of the first point.
- * @param lat2 Latitude in radians of the second point.
- * @param long2 Longitude in radians of the second point.
+ * A* heuristic of Graph::A_star over the map: straight line distance from a vertex to the destination
+ * (see GeoPoints::lowerBoundKm), travelled at subway speed, so it never overestimates. A_star only
+ * calls it for the vertices it reaches, once each.
  */
-static long double haversine_km(long double lat1, long double long1,
-		long double lat2, long double long2) {
-	long double dlong = (long2 - long1);
-	long double dlat = (lat2 - lat1);
-	long double a = pow(sin(dlat / 2.0), 2)
-			+ cos(lat1) * cos(lat2) * pow(sin(dlong / 2.0), 2);
-	long double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-	long double d = 6367 * c;
+template<>
+struct heuristicFunc<NoInfo> {
+	const GeoPoints * pontos;
+	double destino[3];
+	/**
+	 * @param pontos the coordinates of the vertices of the graph, by index
+	 */
+	heuristicFunc(const GeoPoints &pontos, const NoInfo &destino) :
+			pontos(&pontos) {
+		unitVector(destino.latitude, destino.longitude, this->destino);
+	}
+	template<class V>
+	long double operator()(const V * a) const {
+		return pontos->lowerBoundKm(a->getIndex(), destino) / VELOCIDADE_METRO;
+	}
+};
 
-	return d;
-}
+/**
+ * A* heuristic for the routing snapshot: straight line distance from a vertex to the destination,
+ * travelled at subway speed (the fastest mode of transportation), so it never overestimates.
+ * The line is the chord through the Earth (see GeoPoints::lowerBoundKm), which is never longer than
+ * the great circle and needs no trigonometry per vertex.
+ * The straight line is symmetric, so given the origin it also bounds the distance from the origin
+ * (the backward heuristic of bidirectional A*).
+ */
+struct haversineHeuristic {
+	const GeoPoints * pontos;
+	double destino[3];
+	/**
+	 * @param pontos the coordinates of the vertices of the snapshot, by index
+	 */
+	haversineHeuristic(const GeoPoints &pontos, const NoInfo &destino) :
+			pontos(&pontos) {
+		unitVector(destino.latitude, destino.longitude, this->destino);
+	}
+	float operator()(unsigned int v) const {
+		return pontos->lowerBoundKm(v, destino) / VELOCIDADE_METRO;
+	}
+};
 
 /**
- * @brief Prepares the usage of the A* algorithm by calculating the distance from all nodes to the destination.
- * @param data the graph being worked on
- * @param destino the destination
+ * Edge weights of the routing snapshot for a table of transports, in the order of todos_transportes
+ * (foot, bus, subway): travelling along a layer takes the length of the edge at the speed of its
+ * transport, and changing from the base layer into a bus or subway layer takes the waiting time of that
+ * transport. The lengths and the kind of each edge only depend on the topology and are computed once,
+ * so a new table only changes the weights (see MultilevelOverlay::customize).
+ * By default the speeds are the ones used to load the map, with no waiting times.
  */
-static void preparaA_star(Graph<NoInfo> &data, const NoInfo& destino) {
+struct transportWeights {
+	vector<double> comprimento; //km
+	vector<unsigned char> modo; //0..2 viagem nesse transporte, 3 + t entrada no transporte t
+	double velocidade[3];
+	double espera[3];
 
-	for (unsigned int i = 0; i < data.getVertexSet().size(); i++) {
-		data.getVertexSet()[i]->setDestiny(
-				haversine_km(data.getVertexSet()[i]->getInfo().latitude,
-						data.getVertexSet()[i]->getInfo().longitude,
-						destino.longitude, destino.longitude)/VELOCIDADE_METRO);
+	transportWeights(const FrozenGraph<NoInfo> &grafo) {
+		velocidade[0] = VELOCIDADE_PE;
+		velocidade[1] = VELOCIDADE_AUTOCARRO;
+		velocidade[2] = VELOCIDADE_METRO;
+		espera[0] = espera[1] = espera[2] = 0;
+		GeoPoints pontos(grafo);
+		comprimento.reserve(grafo.getNumEdges());
+		modo.reserve(grafo.getNumEdges());
+		for (unsigned int v = 0; v < grafo.getNumVertex(); v++) {
+			const NoInfo &origem = grafo.getInfo(v);
+			for (unsigned int e = grafo.edgesBegin(v); e < grafo.edgesEnd(v); e++) {
+				const NoInfo &destino = grafo.getInfo(grafo.getTarget(e));
+				comprimento.push_back(pontos.distanceKm(v, grafo.getTarget(e)));
+				unsigned char t = destino.layer == 'A' ? 1 : destino.layer == 'M' ? 2 : 0;
+				modo.push_back(origem.layer == destino.layer ? t : 3 + t);
+			}
+		}
+	}
+	/**
+	 * @brief Takes the speeds (km/h) and waiting times (h) of the given transports.
+	 */
+	void setTransportes(const vector<Transporte> &transportes) {
+		for (unsigned int t = 0; t < 3 && t < transportes.size(); t++) {
+			velocidade[t] = transportes[t].getVelocidadeMedia();
+			espera[t] = transportes[t].getTempoEspera();
+		}
 	}
-}
+	float operator()(unsigned int e) const {
+		return modo[e] < 3 ?
+				(float) (comprimento[e] / velocidade[modo[e]]) :
+				(modo[e] == 3 ? 0 : (float) espera[modo[e] - 3]);
+	}
+};
 
 #endif /* SRC_UTILS_H_ */